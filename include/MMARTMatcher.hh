@@ -0,0 +1,186 @@
+///
+///  \file   MMARTMatcher.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMARTMatcher_HH
+#define MMARTMatcher_HH
+
+#include <cmath>
+
+#include "include/MMClusterList.hh"
+#include "include/TPHit.hh"
+#include "include/MMBoardMap.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMARTMatcher class
+//
+// Matches ART trigger primitives (TPHit) to
+// the clusters of an event. Clusters are
+// bucketed once per event by (board, VMM) of
+// every VMM they touch, so a primitive only
+// looks at the few clusters of its own VMM;
+// the closest one within the window (in
+// strips, cluster barycentre) is its match
+///////////////////////////////////////////////
+
+class MMARTMatcher {
+
+public:
+  MMARTMatcher(double window = 4.);
+  ~MMARTMatcher() {}
+
+  void SetWindow(double window);
+
+  // builds the (board, VMM) index, one cluster list per board
+  void Index(const vector<MMClusterList>& clusters_perboard);
+
+  int GetNClusters() const;
+  const MMCluster& Cluster(int iclus) const;
+  double ClusterChannel(int iclus) const;
+  int ClusterBoard(int iclus) const;
+
+  // closest cluster within the window, -1 if none
+  int Match(const TPHit& art) const;
+
+  // matches every primitive (match[i] for arts[i])
+  // and flags the clusters that were matched
+  int MatchAll(const vector<TPHit>& arts, vector<int>& match);
+  bool IsMatched(int iclus) const;
+
+private:
+  static const int NSLOT = MMBoardMap::NBOARD+1;
+  static const int NVMM  = MMBoardMap::NVMM;
+
+  double m_window;
+
+  vector<const MMCluster*> m_clusters;
+  vector<double> m_channel; // barycentre
+  vector<int> m_board;      // layer index
+  vector<char> m_matched;
+
+  // clusters of bucket (slot, vmm): m_bucket[m_first[s][v] ... m_first[s][v+1])
+  int m_first[NSLOT*NVMM+1];
+  vector<int> m_bucket;
+  vector<int> m_vmm_lo;
+  vector<int> m_vmm_hi;
+  vector<int> m_slot;
+};
+
+inline MMARTMatcher::MMARTMatcher(double window){
+  m_window = window;
+  for(int b = 0; b <= NSLOT*NVMM; b++)
+    m_first[b] = 0;
+}
+
+inline void MMARTMatcher::SetWindow(double window){
+  m_window = window;
+}
+
+inline void MMARTMatcher::Index(const vector<MMClusterList>& clusters_perboard){
+  m_clusters.clear();
+  m_channel.clear();
+  m_board.clear();
+  m_vmm_lo.clear();
+  m_vmm_hi.clear();
+  m_slot.clear();
+
+  for(auto& clus_list: clusters_perboard){
+    int Nclus = clus_list.GetNCluster();
+    for(int c = 0; c < Nclus; c++){
+      const MMCluster& clus = clus_list[c];
+      int Nhit = clus.GetNHits();
+      if(Nhit == 0)
+        continue;
+      m_clusters.push_back(&clus);
+      m_channel.push_back(clus.Channel());
+      m_board.push_back(clus.MMFE8Index());
+      m_slot.push_back(MMBoardMap::Slot(clus.MMFE8()));
+      // hits are sorted by channel
+      m_vmm_lo.push_back(std::max(0, std::min(NVMM-1, clus[0].VMM())));
+      m_vmm_hi.push_back(std::max(0, std::min(NVMM-1, clus[Nhit-1].VMM())));
+    }
+  }
+  int Nclus = m_clusters.size();
+  m_matched.assign(Nclus, 0);
+
+  // counting sort of the clusters into their buckets
+  int count[NSLOT*NVMM+1];
+  for(int b = 0; b <= NSLOT*NVMM; b++)
+    count[b] = 0;
+  for(int c = 0; c < Nclus; c++)
+    for(int v = m_vmm_lo[c]; v <= m_vmm_hi[c]; v++)
+      count[m_slot[c]*NVMM + v + 1]++;
+  m_first[0] = 0;
+  for(int b = 1; b <= NSLOT*NVMM; b++)
+    m_first[b] = m_first[b-1] + count[b];
+
+  m_bucket.resize(m_first[NSLOT*NVMM]);
+  for(int b = 0; b < NSLOT*NVMM; b++)
+    count[b] = m_first[b];
+  for(int c = 0; c < Nclus; c++)
+    for(int v = m_vmm_lo[c]; v <= m_vmm_hi[c]; v++)
+      m_bucket[count[m_slot[c]*NVMM + v]++] = c;
+}
+
+inline int MMARTMatcher::GetNClusters() const {
+  return int(m_clusters.size());
+}
+
+inline const MMCluster& MMARTMatcher::Cluster(int iclus) const {
+  return *m_clusters[iclus];
+}
+
+inline double MMARTMatcher::ClusterChannel(int iclus) const {
+  return m_channel[iclus];
+}
+
+inline int MMARTMatcher::ClusterBoard(int iclus) const {
+  return m_board[iclus];
+}
+
+inline int MMARTMatcher::Match(const TPHit& art) const {
+  int vmm = art.VMM();
+  if(vmm < 0 || vmm >= NVMM)
+    return -1;
+  int b = MMBoardMap::Slot(art.MMFE8())*NVMM + vmm;
+
+  int best = -1;
+  double best_dist = 0.;
+  double ch = art.Channel();
+  for(int i = m_first[b]; i < m_first[b+1]; i++){
+    int c = m_bucket[i];
+    double dist = fabs(ch - m_channel[c]);
+    if(dist <= m_window && (best < 0 || dist < best_dist)){
+      best_dist = dist;
+      best = c;
+    }
+  }
+  return best;
+}
+
+inline int MMARTMatcher::MatchAll(const vector<TPHit>& arts, vector<int>& match){
+  int Nart = arts.size();
+  int Nmatch = 0;
+  match.resize(Nart);
+  for(int i = 0; i < Nart; i++){
+    match[i] = Match(arts[i]);
+    if(match[i] >= 0){
+      m_matched[match[i]] = 1;
+      Nmatch++;
+    }
+  }
+  return Nmatch;
+}
+
+inline bool MMARTMatcher::IsMatched(int iclus) const {
+  return m_matched[iclus];
+}
+
+#endif
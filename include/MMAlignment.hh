@@ -0,0 +1,434 @@
+///
+///  \file   MMAlignment.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMAlignment_HH
+#define MMAlignment_HH
+
+#include <iostream>
+#include <fstream>
+#include <vector>
+#include <cmath>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TDirectory.h>
+
+#include "include/MMQuantileSketch.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMAlignment class
+//
+// One-pass board 0 - board 1 alignment. Each
+// track adds dx = x_0 - x_1 (without offset)
+// at x = x_1 to sufficient statistics: the
+// sums of a least-squares line, and a
+// quantile sketch of dx overall and in bins
+// of x. Solve() then gives
+//
+//   offset = -median(dx)                (offset only)
+//   dx = a + b x, robust line through
+//   the per-bin medians, weighted by
+//   N / width^2:  offset = -a, slope = -b
+//
+// so that x_0 - x_1 + offset + slope x_1 is
+// centred on 0, as the conditions expect
+// (keys offset and offset_slope).
+//
+// Save() stores the statistics as trees, which
+// Read() merges back, so that shards and
+// workers are solved once, after the merge
+// (SolveFile)
+///////////////////////////////////////////////
+
+class MMAlignment {
+
+public:
+  MMAlignment(double xmin = 0.8, double xmax = 23.6, int Nbin = 12);
+  ~MMAlignment() {}
+
+  void Fill(double x, double dx);
+  void Merge(const MMAlignment& other);
+
+  // fit_slope: also solve for the position dependence
+  bool Solve(bool fit_slope = false);
+
+  double GetN() const;
+  double Offset() const;
+  double OffsetError() const;
+  double Slope() const;
+  double SlopeError() const;
+  // robust width of dx (half of the 16% - 84% range)
+  double Width() const;
+  // plain least-squares line through all tracks, for comparison
+  double LSQOffset() const;
+  double LSQSlope() const;
+
+  // conditions-file lines for runs first - last (see MMConditions)
+  bool Write(const string& filename, int first_run, int last_run) const;
+  void Print() const;
+
+  // state trees alignment_sums and alignment_sketch,
+  // into the current directory
+  void Save();
+  // merges the state saved in dir
+  bool Read(TDirectory* dir);
+
+  // solves the merged state of an output file (directory
+  // "alignment") and writes the conditions lines of its run
+  static bool SolveFile(const string& output, const string& filename, bool fit_slope = false);
+
+private:
+  double m_xmin;
+  double m_xmax;
+  int m_Nbin;
+
+  // least-squares sums of (x, dx)
+  double m_S;
+  double m_Sx;
+  double m_Sy;
+  double m_Sxx;
+  double m_Sxy;
+
+  MMQuantileSketch m_dx;
+  vector<MMQuantileSketch> m_dx_bin;
+  vector<double> m_x_bin; // sum of x per bin
+
+  bool m_solved;
+  bool m_fit_slope;
+  double m_offset;
+  double m_offset_err;
+  double m_slope;
+  double m_slope_err;
+  double m_width;
+};
+
+inline MMAlignment::MMAlignment(double xmin, double xmax, int Nbin)
+  : m_dx_bin(Nbin), m_x_bin(Nbin, 0.) {
+  m_xmin = xmin;
+  m_xmax = xmax;
+  m_Nbin = Nbin;
+  m_S = 0.;
+  m_Sx = 0.;
+  m_Sy = 0.;
+  m_Sxx = 0.;
+  m_Sxy = 0.;
+  m_solved = false;
+  m_fit_slope = false;
+  m_offset = 0.;
+  m_offset_err = 0.;
+  m_slope = 0.;
+  m_slope_err = 0.;
+  m_width = 0.;
+}
+
+inline void MMAlignment::Fill(double x, double dx){
+  m_S   += 1.;
+  m_Sx  += x;
+  m_Sy  += dx;
+  m_Sxx += x*x;
+  m_Sxy += x*dx;
+  m_dx.Add(dx);
+
+  int b = int((x - m_xmin)/(m_xmax - m_xmin)*m_Nbin);
+  if(b < 0 || b >= m_Nbin)
+    return;
+  m_dx_bin[b].Add(dx);
+  m_x_bin[b] += x;
+}
+
+inline void MMAlignment::Merge(const MMAlignment& other){
+  m_S   += other.m_S;
+  m_Sx  += other.m_Sx;
+  m_Sy  += other.m_Sy;
+  m_Sxx += other.m_Sxx;
+  m_Sxy += other.m_Sxy;
+  m_dx.Merge(other.m_dx);
+  for(int b = 0; b < m_Nbin && b < other.m_Nbin; b++){
+    m_dx_bin[b].Merge(other.m_dx_bin[b]);
+    m_x_bin[b] += other.m_x_bin[b];
+  }
+  m_solved = false;
+}
+
+inline bool MMAlignment::Solve(bool fit_slope){
+  m_solved = false;
+  m_fit_slope = fit_slope;
+  if(m_S < 1.)
+    return false;
+
+  double median = m_dx.Quantile(0.5);
+  m_width  = (m_dx.Quantile(0.84) - m_dx.Quantile(0.16))/2.;
+  // error of a median: sqrt(pi/2) sigma / sqrt(N)
+  m_offset = -median;
+  m_offset_err = 1.2533*m_width/sqrt(m_S);
+  m_slope = 0.;
+  m_slope_err = 0.;
+
+  if(fit_slope){
+    // weighted line through the bin medians
+    double W = 0., Wx = 0., Wy = 0., Wxx = 0., Wxy = 0.;
+    int Nused = 0;
+    for(int b = 0; b < m_Nbin; b++){
+      MMQuantileSketch& sketch = m_dx_bin[b];
+      double N = sketch.GetN();
+      if(N < 20.)
+        continue;
+      double width = (sketch.Quantile(0.84) - sketch.Quantile(0.16))/2.;
+      if(width <= 0.)
+        continue;
+      double x = m_x_bin[b]/N;
+      double y = sketch.Quantile(0.5);
+      double w = N/(1.5708*width*width);
+      W   += w;
+      Wx  += w*x;
+      Wy  += w*y;
+      Wxx += w*x*x;
+      Wxy += w*x*y;
+      Nused++;
+    }
+    double det = W*Wxx - Wx*Wx;
+    if(Nused < 2 || det <= 0.){
+      cout << "MMAlignment WARNING: not enough populated x bins for a slope, solving for the offset only" << endl;
+      m_fit_slope = false;
+    } else {
+      double a = (Wxx*Wy - Wx*Wxy)/det;
+      double b = (W*Wxy - Wx*Wy)/det;
+      m_offset = -a;
+      m_slope  = -b;
+      m_offset_err = sqrt(Wxx/det);
+      m_slope_err  = sqrt(W/det);
+    }
+  }
+
+  m_solved = true;
+  return true;
+}
+
+inline double MMAlignment::GetN() const {
+  return m_S;
+}
+
+inline double MMAlignment::Offset() const {
+  return m_offset;
+}
+
+inline double MMAlignment::OffsetError() const {
+  return m_offset_err;
+}
+
+inline double MMAlignment::Slope() const {
+  return m_slope;
+}
+
+inline double MMAlignment::SlopeError() const {
+  return m_slope_err;
+}
+
+inline double MMAlignment::Width() const {
+  return m_width;
+}
+
+inline double MMAlignment::LSQOffset() const {
+  double det = m_S*m_Sxx - m_Sx*m_Sx;
+  if(det <= 0.)
+    return m_S > 0. ? -m_Sy/m_S : 0.;
+  return -(m_Sxx*m_Sy - m_Sx*m_Sxy)/det;
+}
+
+inline double MMAlignment::LSQSlope() const {
+  double det = m_S*m_Sxx - m_Sx*m_Sx;
+  if(det <= 0.)
+    return 0.;
+  return -(m_S*m_Sxy - m_Sx*m_Sy)/det;
+}
+
+inline bool MMAlignment::Write(const string& filename, int first_run, int last_run) const {
+  if(!m_solved){
+    cout << "MMAlignment ERROR: no solution to write for runs " << first_run << " - " << last_run << endl;
+    return false;
+  }
+  ofstream file(filename.c_str());
+  if(!file.is_open()){
+    cout << "MMAlignment ERROR: cannot write " << filename << endl;
+    return false;
+  }
+  file << "# alignment from " << m_S << " tracks, dx width " << m_width
+       << " mm, offset error " << m_offset_err << " mm" << endl;
+  file << first_run << " " << last_run << " offset " << m_offset << endl;
+  if(m_fit_slope)
+    file << first_run << " " << last_run << " offset_slope " << m_slope << endl;
+  return true;
+}
+
+inline void MMAlignment::Print() const {
+  cout << "MMAlignment: " << m_S << " tracks, offset " << m_offset << " +- " << m_offset_err << " mm";
+  if(m_fit_slope)
+    cout << ", slope " << m_slope << " +- " << m_slope_err;
+  cout << ", dx width " << m_width << " mm (least squares: offset " << LSQOffset()
+       << ", slope " << LSQSlope() << ")" << endl;
+}
+
+inline void MMAlignment::Save(){
+  TTree* sums = new TTree("alignment_sums", "alignment_sums");
+  sums->Branch("xmin", &m_xmin, "xmin/D");
+  sums->Branch("xmax", &m_xmax, "xmax/D");
+  sums->Branch("Nbin", &m_Nbin, "Nbin/I");
+  sums->Branch("S",    &m_S,    "S/D");
+  sums->Branch("Sx",   &m_Sx,   "Sx/D");
+  sums->Branch("Sy",   &m_Sy,   "Sy/D");
+  sums->Branch("Sxx",  &m_Sxx,  "Sxx/D");
+  sums->Branch("Sxy",  &m_Sxy,  "Sxy/D");
+  sums->Fill();
+  sums->Write();
+  delete sums;
+
+  // one row per centroid, bin -1 is the overall sketch;
+  // min, max, moments and the x sum repeated on every row
+  int bin;
+  double mean, weight, min, max, sum, sum2, xsum;
+  TTree* tree = new TTree("alignment_sketch", "alignment_sketch");
+  tree->Branch("bin",    &bin,    "bin/I");
+  tree->Branch("mean",   &mean,   "mean/D");
+  tree->Branch("weight", &weight, "weight/D");
+  tree->Branch("min",    &min,    "min/D");
+  tree->Branch("max",    &max,    "max/D");
+  tree->Branch("sum",    &sum,    "sum/D");
+  tree->Branch("sum2",   &sum2,   "sum2/D");
+  tree->Branch("xsum",   &xsum,   "xsum/D");
+  for(bin = -1; bin < m_Nbin; bin++){
+    MMQuantileSketch& sketch = (bin < 0) ? m_dx : m_dx_bin[bin];
+    if(sketch.GetN() == 0.)
+      continue;
+    sketch.Compress();
+    min  = sketch.Min();
+    max  = sketch.Max();
+    sum  = sketch.Sum();
+    sum2 = sketch.Sum2();
+    xsum = (bin < 0) ? m_Sx : m_x_bin[bin];
+    for(int c = 0; c < sketch.GetNCentroids(); c++){
+      mean   = sketch.CentroidMean(c);
+      weight = sketch.CentroidWeight(c);
+      tree->Fill();
+    }
+  }
+  tree->Write();
+  delete tree;
+}
+
+inline bool MMAlignment::Read(TDirectory* dir){
+  TTree* sums = dir ? (TTree*) dir->Get("alignment_sums") : nullptr;
+  TTree* tree = dir ? (TTree*) dir->Get("alignment_sketch") : nullptr;
+  if(!sums || !tree || sums->GetEntries() < 1)
+    return false;
+
+  double xmin, xmax, S, Sx, Sy, Sxx, Sxy;
+  int Nbin;
+  sums->SetBranchAddress("xmin", &xmin);
+  sums->SetBranchAddress("xmax", &xmax);
+  sums->SetBranchAddress("Nbin", &Nbin);
+  sums->SetBranchAddress("S",    &S);
+  sums->SetBranchAddress("Sx",   &Sx);
+  sums->SetBranchAddress("Sy",   &Sy);
+  sums->SetBranchAddress("Sxx",  &Sxx);
+  sums->SetBranchAddress("Sxy",  &Sxy);
+  sums->GetEntry(0);
+  if(m_S == 0.){
+    m_xmin = xmin;
+    m_xmax = xmax;
+    m_Nbin = Nbin;
+    m_dx_bin.assign(Nbin, MMQuantileSketch());
+    m_x_bin.assign(Nbin, 0.);
+  } else if(xmin != m_xmin || xmax != m_xmax || Nbin != m_Nbin){
+    cout << "MMAlignment ERROR: x bins of " << dir->GetPath() << " differ, not merged" << endl;
+    return false;
+  }
+  m_S   += S;
+  m_Sx  += Sx;
+  m_Sy  += Sy;
+  m_Sxx += Sxx;
+  m_Sxy += Sxy;
+
+  int bin;
+  double mean, weight, min, max, sum, sum2, xsum;
+  tree->SetBranchAddress("bin",    &bin);
+  tree->SetBranchAddress("mean",   &mean);
+  tree->SetBranchAddress("weight", &weight);
+  tree->SetBranchAddress("min",    &min);
+  tree->SetBranchAddress("max",    &max);
+  tree->SetBranchAddress("sum",    &sum);
+  tree->SetBranchAddress("sum2",   &sum2);
+  tree->SetBranchAddress("xsum",   &xsum);
+
+  // rows of a bin are contiguous
+  vector<double> means, weights;
+  int cur_bin = -2;
+  double cur_min = 0., cur_max = 0., cur_sum = 0., cur_sum2 = 0., cur_xsum = 0.;
+  Long64_t N = tree->GetEntries();
+  for(Long64_t i = 0; i <= N; i++){
+    if(i < N)
+      tree->GetEntry(i);
+    if(i == N || bin != cur_bin){
+      if(cur_bin == -1){
+        m_dx.AddCentroids(means, weights, cur_min, cur_max, cur_sum, cur_sum2);
+      } else if(cur_bin >= 0 && cur_bin < m_Nbin){
+        m_dx_bin[cur_bin].AddCentroids(means, weights, cur_min, cur_max, cur_sum, cur_sum2);
+        m_x_bin[cur_bin] += cur_xsum;
+      }
+      if(i == N)
+        break;
+      means.clear();
+      weights.clear();
+      cur_bin  = bin;
+      cur_min  = min;
+      cur_max  = max;
+      cur_sum  = sum;
+      cur_sum2 = sum2;
+      cur_xsum = xsum;
+    }
+    means.push_back(mean);
+    weights.push_back(weight);
+  }
+  m_solved = false;
+  return true;
+}
+
+inline bool MMAlignment::SolveFile(const string& output, const string& filename, bool fit_slope){
+  TFile* f = new TFile(output.c_str(), "READ");
+  if(!f || f->IsZombie()){
+    cout << "MMAlignment ERROR: cannot open " << output << endl;
+    delete f;
+    return false;
+  }
+  int run = -1;
+  TTree* info = (TTree*) f->Get("analysis_info");
+  if(info && info->GetEntries() > 0){
+    info->SetBranchAddress("runNumber", &run);
+    info->GetEntry(0);
+  }
+  MMAlignment align;
+  bool ok = align.Read(f->GetDirectory("alignment"));
+  f->Close();
+  delete f;
+  if(!ok){
+    cout << "MMAlignment ERROR: no alignment state in " << output << " (analyzed without --align?)" << endl;
+    return false;
+  }
+
+  cout << "Run " << run << ": ";
+  if(!align.Solve(fit_slope)){
+    cout << "no tracks for the alignment" << endl;
+    return false;
+  }
+  align.Print();
+  return align.Write(filename, run, run);
+}
+
+#endif
@@ -0,0 +1,191 @@
+///
+///  \file   MMAnalysisServer.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMAnalysisServer_HH
+#define MMAnalysisServer_HH
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <sstream>
+#include <cstring>
+
+#include <unistd.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMAnalysisServer class
+//
+// Line protocol over a local UNIX socket, one
+// connection per request: the client sends
+// one line (analysis options, as on the
+// command line) and gets one line back
+// ("OK ..." or "ERROR ..."). Requests are
+// served one at a time by the daemon loop of
+// RunTBAnalysis (--serve); Send() is the
+// client side (--connect)
+///////////////////////////////////////////////
+
+class MMAnalysisServer {
+
+public:
+  MMAnalysisServer();
+  ~MMAnalysisServer();
+
+  bool Listen(const string& path);
+  // waits for the next request, false if the socket failed
+  bool Accept(string& request);
+  void Reply(const string& reply);
+  void Close();
+
+  static bool Send(const string& path, const string& request, string& reply);
+  // whitespace-separated words of a request
+  static vector<string> Split(const string& request);
+
+private:
+  string m_path;
+  int m_fd;
+  int m_client;
+
+  static bool SetAddress(const string& path, struct sockaddr_un& addr);
+  static bool ReadLine(int fd, string& line);
+  static bool WriteLine(int fd, const string& line);
+};
+
+inline MMAnalysisServer::MMAnalysisServer(){
+  m_fd = -1;
+  m_client = -1;
+}
+
+inline MMAnalysisServer::~MMAnalysisServer(){
+  Close();
+}
+
+inline bool MMAnalysisServer::SetAddress(const string& path, struct sockaddr_un& addr){
+  memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  if(path.size() >= sizeof(addr.sun_path)){
+    cout << "MMAnalysisServer ERROR: socket path too long: " << path << endl;
+    return false;
+  }
+  strncpy(addr.sun_path, path.c_str(), sizeof(addr.sun_path)-1);
+  return true;
+}
+
+inline bool MMAnalysisServer::Listen(const string& path){
+  Close();
+  struct sockaddr_un addr;
+  if(!SetAddress(path, addr))
+    return false;
+  m_fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(m_fd < 0){
+    cout << "MMAnalysisServer ERROR: cannot create a socket" << endl;
+    return false;
+  }
+  // stale socket of a previous daemon
+  unlink(path.c_str());
+  if(bind(m_fd, (struct sockaddr*) &addr, sizeof(addr)) != 0 || listen(m_fd, 4) != 0){
+    cout << "MMAnalysisServer ERROR: cannot listen on " << path << endl;
+    Close();
+    return false;
+  }
+  m_path = path;
+  return true;
+}
+
+inline bool MMAnalysisServer::Accept(string& request){
+  if(m_fd < 0)
+    return false;
+  while(true){
+    m_client = accept(m_fd, 0, 0);
+    if(m_client < 0)
+      return false;
+    if(ReadLine(m_client, request))
+      return true;
+    // client gone before sending a full line
+    close(m_client);
+    m_client = -1;
+  }
+}
+
+inline void MMAnalysisServer::Reply(const string& reply){
+  if(m_client < 0)
+    return;
+  WriteLine(m_client, reply);
+  close(m_client);
+  m_client = -1;
+}
+
+inline void MMAnalysisServer::Close(){
+  if(m_client >= 0)
+    close(m_client);
+  if(m_fd >= 0)
+    close(m_fd);
+  if(!m_path.empty())
+    unlink(m_path.c_str());
+  m_client = -1;
+  m_fd = -1;
+  m_path.clear();
+}
+
+inline bool MMAnalysisServer::Send(const string& path, const string& request, string& reply){
+  struct sockaddr_un addr;
+  if(!SetAddress(path, addr))
+    return false;
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if(fd < 0)
+    return false;
+  if(connect(fd, (struct sockaddr*) &addr, sizeof(addr)) != 0){
+    cout << "MMAnalysisServer ERROR: no daemon listening on " << path << endl;
+    close(fd);
+    return false;
+  }
+  bool ok = WriteLine(fd, request) && ReadLine(fd, reply);
+  close(fd);
+  return ok;
+}
+
+inline vector<string> MMAnalysisServer::Split(const string& request){
+  vector<string> words;
+  istringstream stream(request);
+  string word;
+  while(stream >> word)
+    words.push_back(word);
+  return words;
+}
+
+inline bool MMAnalysisServer::ReadLine(int fd, string& line){
+  line.clear();
+  char c;
+  while(true){
+    ssize_t n = read(fd, &c, 1);
+    if(n <= 0)
+      return false;
+    if(c == '\n')
+      return true;
+    line += c;
+  }
+}
+
+inline bool MMAnalysisServer::WriteLine(int fd, const string& line){
+  string data = line + "\n";
+  size_t done = 0;
+  while(done < data.size()){
+    ssize_t n = write(fd, data.data() + done, data.size() - done);
+    if(n <= 0)
+      return false;
+    done += n;
+  }
+  return true;
+}
+
+#endif
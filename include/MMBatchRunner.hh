@@ -0,0 +1,304 @@
+///
+///  \file   MMBatchRunner.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMBatchRunner_HH
+#define MMBatchRunner_HH
+
+#include <glob.h>
+#include <unistd.h>
+#include <sys/wait.h>
+
+#include <fstream>
+#include <functional>
+
+#include <TFile.h>
+#include <TTree.h>
+
+#include "include/MMRunProperties.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMBatchJob class
+//
+// All input files belonging to one run
+// (chained together) and the per-run
+// output file they are analyzed into
+///////////////////////////////////////////////
+
+class MMBatchJob {
+
+public:
+  MMBatchJob(int RunNumber = -1);
+  ~MMBatchJob() {}
+
+  int RunNumber() const;
+  int GetNFiles() const;
+  const string& File(int i) const;
+  const string& Output() const;
+  int Status() const;
+
+  void AddFile(const string& filename);
+  void SetOutput(const string& output);
+  void SetStatus(int status);
+
+private:
+  int m_RunNumber;
+  vector<string> m_files;
+  string m_output;
+  int m_status;
+};
+
+///////////////////////////////////////////////
+// MMBatchRunner class
+//
+// Groups input files by run number (read
+// from run_properties) and runs one job per
+// run in a pool of forked worker processes
+///////////////////////////////////////////////
+
+class MMBatchRunner {
+
+public:
+  MMBatchRunner();
+  ~MMBatchRunner() {}
+
+  // accepts a single .root file, a glob pattern
+  // or a text file with one file (or glob) per line
+  int AddInput(const string& spec);
+  bool AddFile(const string& filename);
+
+  // output of run N is <stem>_run<N>.root
+  void SetOutputStem(const string& stem);
+
+  int GetNJobs() const;
+  MMBatchJob const& Get(int i) const;
+  MMBatchJob const& operator [] (int i) const;
+
+  // runs func(job) for each job in at most
+  // njobs parallel processes; returns number of failed jobs
+  int Run(int njobs, function<int(const MMBatchJob&)> func);
+
+  static int GetNCores();
+
+private:
+  vector<MMBatchJob> m_jobs;
+  string m_stem;
+
+  int GlobFiles(const string& pattern, vector<string>& files) const;
+  int ReadRunNumber(const string& filename) const;
+};
+
+inline MMBatchJob::MMBatchJob(int RunNumber){
+  m_RunNumber = RunNumber;
+  m_status = -1;
+}
+
+inline int MMBatchJob::RunNumber() const {
+  return m_RunNumber;
+}
+
+inline int MMBatchJob::GetNFiles() const {
+  return int(m_files.size());
+}
+
+inline const string& MMBatchJob::File(int i) const {
+  return m_files[i];
+}
+
+inline const string& MMBatchJob::Output() const {
+  return m_output;
+}
+
+inline int MMBatchJob::Status() const {
+  return m_status;
+}
+
+inline void MMBatchJob::AddFile(const string& filename){
+  m_files.push_back(filename);
+}
+
+inline void MMBatchJob::SetOutput(const string& output){
+  m_output = output;
+}
+
+inline void MMBatchJob::SetStatus(int status){
+  m_status = status;
+}
+
+inline MMBatchRunner::MMBatchRunner(){
+  m_stem = "output";
+}
+
+inline int MMBatchRunner::GetNCores(){
+  long ncores = sysconf(_SC_NPROCESSORS_ONLN);
+  if(ncores < 1)
+    return 1;
+  return int(ncores);
+}
+
+inline int MMBatchRunner::GlobFiles(const string& pattern, vector<string>& files) const {
+  glob_t gl;
+  int N = 0;
+  if(glob(pattern.c_str(), 0, NULL, &gl) == 0){
+    for(size_t i = 0; i < gl.gl_pathc; i++){
+      files.push_back(gl.gl_pathv[i]);
+      N++;
+    }
+  }
+  globfree(&gl);
+  return N;
+}
+
+inline int MMBatchRunner::AddInput(const string& spec){
+  vector<string> files;
+
+  bool is_pattern = spec.find_first_of("*?[") != string::npos;
+  bool is_root    = spec.size() > 5 && spec.compare(spec.size()-5, 5, ".root") == 0;
+
+  if(is_pattern || is_root){
+    GlobFiles(spec, files);
+  } else {
+    ifstream list(spec.c_str());
+    if(!list.is_open()){
+      cout << "MMBatchRunner ERROR: cannot open file list " << spec << endl;
+      return 0;
+    }
+    string line;
+    while(getline(list, line)){
+      line.erase(0, line.find_first_not_of(" \t"));
+      line.erase(line.find_last_not_of(" \t\r")+1);
+      if(line.empty() || line[0] == '#')
+        continue;
+      GlobFiles(line, files);
+    }
+  }
+
+  int Nadd = 0;
+  for(auto filename: files)
+    if(AddFile(filename))
+      Nadd++;
+  return Nadd;
+}
+
+inline int MMBatchRunner::ReadRunNumber(const string& filename) const {
+  TFile f(filename.c_str(), "READ");
+  if(f.IsZombie())
+    return -1;
+  TTree* R = (TTree*) f.Get("run_properties");
+  if(!R || R->GetEntries() < 1)
+    return -1;
+  MMRunProperties props(R);
+  props.GetEntry(0);
+  int run = props.runNumber;
+  // tree is owned by the file
+  props.fChain = 0;
+  f.Close();
+  return run;
+}
+
+inline bool MMBatchRunner::AddFile(const string& filename){
+  int run = ReadRunNumber(filename);
+  if(run < 0){
+    cout << "MMBatchRunner ERROR: no run_properties in " << filename << ", skipping" << endl;
+    return false;
+  }
+
+  int N = GetNJobs();
+  for(int i = 0; i < N; i++){
+    if(m_jobs[i].RunNumber() == run){
+      m_jobs[i].AddFile(filename);
+      return true;
+    }
+  }
+  // keep jobs ordered by run number
+  MMBatchJob job(run);
+  job.AddFile(filename);
+  job.SetOutput(Form("%s_run%04d.root", m_stem.c_str(), run));
+  int i = 0;
+  while(i < N && m_jobs[i].RunNumber() < run)
+    i++;
+  m_jobs.insert(m_jobs.begin()+i, job);
+  return true;
+}
+
+inline void MMBatchRunner::SetOutputStem(const string& stem){
+  m_stem = stem;
+  int N = GetNJobs();
+  for(int i = 0; i < N; i++)
+    m_jobs[i].SetOutput(Form("%s_run%04d.root", m_stem.c_str(), m_jobs[i].RunNumber()));
+}
+
+inline int MMBatchRunner::GetNJobs() const {
+  return int(m_jobs.size());
+}
+
+inline MMBatchJob const& MMBatchRunner::Get(int i) const {
+  return m_jobs[i];
+}
+
+inline MMBatchJob const& MMBatchRunner::operator [] (int i) const {
+  return Get(i);
+}
+
+inline int MMBatchRunner::Run(int njobs, function<int(const MMBatchJob&)> func){
+  if(njobs < 1)
+    njobs = 1;
+
+  // flush before forking so children don't replay buffered output
+  cout.flush();
+
+  map<pid_t,int> running;
+  int Njob = GetNJobs();
+  int next = 0;
+  int Nfail = 0;
+
+  while(next < Njob || !running.empty()){
+    while(next < Njob && int(running.size()) < njobs){
+      pid_t pid = fork();
+      if(pid == 0){
+        int ret = func(m_jobs[next]);
+        cout.flush();
+        _exit(ret == 0 ? 0 : 1);
+      }
+      if(pid < 0){
+        cout << "MMBatchRunner ERROR: fork failed for run " << m_jobs[next].RunNumber() << endl;
+        m_jobs[next].SetStatus(1);
+        Nfail++;
+        next++;
+        continue;
+      }
+      running[pid] = next;
+      next++;
+    }
+
+    int wstatus = 0;
+    pid_t pid = waitpid(-1, &wstatus, 0);
+    if(pid < 0)
+      break;
+    if(running.count(pid) == 0)
+      continue;
+
+    int ijob = running[pid];
+    running.erase(pid);
+    int status = (WIFEXITED(wstatus) ? WEXITSTATUS(wstatus) : 1);
+    m_jobs[ijob].SetStatus(status);
+    if(status != 0){
+      Nfail++;
+      cout << "MMBatchRunner ERROR: run " << m_jobs[ijob].RunNumber() << " failed" << endl;
+    } else {
+      cout << "Finished run " << m_jobs[ijob].RunNumber()
+           << " -> " << m_jobs[ijob].Output() << endl;
+    }
+  }
+
+  return Nfail;
+}
+
+#endif
@@ -0,0 +1,220 @@
+///
+///  \file   MMBitmaskAlgo.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMBitmaskAlgo_HH
+#define MMBitmaskAlgo_HH
+
+#include <stdint.h>
+
+#include "include/MMClusterAlgo.hh"
+
+///////////////////////////////////////////////
+// MMBitmaskAlgo class
+//
+// Connected-component clustering on a strip
+// occupancy bitmask. Good hits above the hit
+// threshold set one bit per strip; the mask is
+// dilated by clus_size-1 strips so that hits at
+// most clus_size strips apart become one run of
+// set bits; every run containing a seed above
+// the seed threshold is a cluster.
+//
+// This gives the same clusters (and the same
+// cluster order) as MMPacmanAlgo with identical
+// parameters, as long as seed_thresh >= hit_thresh.
+// GetGoodHits() counts every good hit, while
+// PACMAN skips the hits its forward step absorbs
+///////////////////////////////////////////////
+
+class MMBitmaskAlgo : public MMClusterAlgo {
+
+public:
+  MMBitmaskAlgo(int clus_size = 5,
+                double seed_thresh = 10.,
+                double hit_thresh  = 2.);
+
+  ~MMBitmaskAlgo() {}
+
+  using MMClusterAlgo::Cluster;
+  MMClusterList Cluster(const MMFE8Hits& hits, const vector<char>& good);
+
+  void SetClusterSize(int clus_size);
+  void SetSeedThreshold(double thresh);
+  void SetHitThreshold(double thresh);
+  int GetGoodHits();
+  void SetGoodHits(int nhit);
+
+  // 8 VMMs x 64 strips per board
+  static const int NSTRIP = 512;
+  static const int NWORD  = NSTRIP/64;
+
+private:
+  int m_good_hits; // number of hits in the last clustering
+  int m_clus_size;
+  double m_seed_thresh;
+  double m_hit_thresh;
+
+  uint64_t m_mask[NWORD];    // good hits above hit threshold
+  uint64_t m_dilated[NWORD]; // mask dilated by clus_size-1
+  int m_index[NSTRIP];       // hit index of each set strip
+  int m_run[NSTRIP];         // cluster run of each seed strip
+
+  void ShiftOr(uint64_t* bits, int shift) const;
+  int NextSet(const uint64_t* bits, int pos) const;
+  int NextClear(const uint64_t* bits, int pos) const;
+};
+
+inline MMBitmaskAlgo::MMBitmaskAlgo(int clus_size,
+                                    double seed_thresh,
+                                    double hit_thresh){
+  m_clus_size = clus_size;
+  m_seed_thresh = seed_thresh;
+  m_hit_thresh = hit_thresh;
+  m_good_hits = 0;
+}
+
+// bits |= bits << shift, across word boundaries (towards higher strips)
+inline void MMBitmaskAlgo::ShiftOr(uint64_t* bits, int shift) const {
+  int wshift = shift / 64;
+  int bshift = shift % 64;
+  for(int w = NWORD-1; w >= wshift; w--){
+    uint64_t shifted = bits[w-wshift] << bshift;
+    if(bshift > 0 && w-wshift-1 >= 0)
+      shifted |= bits[w-wshift-1] >> (64-bshift);
+    bits[w] |= shifted;
+  }
+}
+
+// first set bit at or after pos, NSTRIP if none
+inline int MMBitmaskAlgo::NextSet(const uint64_t* bits, int pos) const {
+  if(pos >= NSTRIP)
+    return NSTRIP;
+  int w = pos / 64;
+  uint64_t word = bits[w] & (~uint64_t(0) << (pos % 64));
+  while(word == 0){
+    if(++w == NWORD)
+      return NSTRIP;
+    word = bits[w];
+  }
+  return 64*w + __builtin_ctzll(word);
+}
+
+// first clear bit at or after pos, NSTRIP if none
+inline int MMBitmaskAlgo::NextClear(const uint64_t* bits, int pos) const {
+  if(pos >= NSTRIP)
+    return NSTRIP;
+  int w = pos / 64;
+  uint64_t word = ~bits[w] & (~uint64_t(0) << (pos % 64));
+  while(word == 0){
+    if(++w == NWORD)
+      return NSTRIP;
+    word = ~bits[w];
+  }
+  return 64*w + __builtin_ctzll(word);
+}
+
+inline MMClusterList MMBitmaskAlgo::Cluster(const MMFE8Hits& hits, const vector<char>& good){
+  MMClusterList cluster_list;
+  m_good_hits = 0;
+
+  for(int w = 0; w < NWORD; w++)
+    m_mask[w] = 0;
+
+  // occupancy mask from good hits above threshold
+  int Nhit = hits.GetNHits();
+  for(int i = 0; i < Nhit; i++){
+    if(!good[i])
+      continue;
+    if(hits[i].Channel() == 63)
+      continue;
+    m_good_hits++;
+
+    if(hits[i].Charge() < m_hit_thresh)
+      continue;
+    int strip = int(hits[i].Channel());
+    if(strip < 0 || strip >= NSTRIP)
+      continue;
+    m_mask[strip/64] |= uint64_t(1) << (strip%64);
+    m_index[strip] = i;
+  }
+
+  // dilate: hits up to clus_size strips apart end up in one run
+  for(int w = 0; w < NWORD; w++)
+    m_dilated[w] = m_mask[w];
+  int span = 1;
+  while(span < m_clus_size){
+    int shift = std::min(span, m_clus_size-span);
+    ShiftOr(m_dilated, shift);
+    span += shift;
+  }
+
+  // one cluster per run with a seed: built from the seed upwards
+  // first, as the PACMAN forward step does, so the charge ordering
+  // in the cluster list is the same
+  vector<int> run_first; // first strip of the run
+  vector<int> run_seed;  // seed strip of the run
+  int start = NextSet(m_dilated, 0);
+  while(start < NSTRIP){
+    int end = NextClear(m_dilated, start);
+
+    int seed = -1;
+    for(int s = NextSet(m_mask, start); s < end; s = NextSet(m_mask, s+1)){
+      if(hits[m_index[s]].Charge() >= m_seed_thresh){
+        seed = s;
+        break;
+      }
+    }
+
+    if(seed >= 0){
+      MMCluster cluster(hits[m_index[seed]]);
+      for(int s = NextSet(m_mask, seed+1); s < end; s = NextSet(m_mask, s+1))
+        cluster.AddLinkedHit(hits[m_index[s]]);
+      cluster_list.AddCluster(cluster);
+
+      m_run[seed] = run_first.size();
+      run_first.push_back(start);
+      run_seed.push_back(seed);
+    }
+
+    start = NextSet(m_dilated, end);
+  }
+
+  // strips of each run below its seed (PACMAN backward step)
+  int Nclus = cluster_list.GetNCluster();
+  for(int c = 0; c < Nclus; c++){
+    int r = m_run[int(cluster_list[c][0].Channel())];
+    for(int s = NextSet(m_mask, run_first[r]); s < run_seed[r]; s = NextSet(m_mask, s+1))
+      cluster_list.AddLinkedHit(hits[m_index[s]], c);
+  }
+
+  return cluster_list;
+}
+
+inline void MMBitmaskAlgo::SetClusterSize(int clus_size){
+  if(clus_size >= 1)
+    m_clus_size = clus_size;
+}
+
+inline void MMBitmaskAlgo::SetSeedThreshold(double thresh){
+  m_seed_thresh = thresh;
+}
+
+inline void MMBitmaskAlgo::SetHitThreshold(double thresh){
+  m_hit_thresh = thresh;
+}
+
+inline int MMBitmaskAlgo::GetGoodHits(){
+  return m_good_hits;
+}
+
+inline void MMBitmaskAlgo::SetGoodHits(int nhit){
+  m_good_hits = nhit;
+}
+
+#endif
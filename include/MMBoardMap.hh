@@ -0,0 +1,135 @@
+///
+///  \file   MMBoardMap.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMBoardMap_HH
+#define MMBoardMap_HH
+
+#include <iostream>
+
+///////////////////////////////////////////////
+// MMBoardMap class
+//
+// MMFE8 board id -> layer index of the
+// detector, as a flat lookup table so that
+// the index of every hit is one array read.
+// Defaults to the two-board test beam setup
+// (board 2 -> layer 0, board 3 -> layer 1);
+// an octuplet maps up to NBOARD layers
+///////////////////////////////////////////////
+
+class MMBoardMap {
+
+public:
+  // layers of an octuplet and VMMs per MMFE8
+  static const int NBOARD = 8;
+  static const int NVMM   = 8;
+  static const int MAXID  = 256;
+
+  // layer index of a board, -1 if not mapped
+  static int Index(int mmfe8);
+
+  // as Index, but NBOARD for unmapped boards,
+  // usable as a row of an [NBOARD+1] table
+  static int Slot(int mmfe8);
+
+  // board id of a layer, -1 if not mapped
+  static int MMFE8(int index);
+
+  // number of layers (highest mapped index + 1)
+  static int GetNBoards();
+
+  static void SetIndex(int mmfe8, int index);
+  static void Clear();
+  static void SetDefault();
+
+private:
+  struct Table {
+    int index[MAXID];
+    int mmfe8[NBOARD];
+    int Nboard;
+  };
+  static Table& Get();
+  static Table Default();
+};
+
+inline MMBoardMap::Table& MMBoardMap::Get(){
+  static Table table = Default();
+  return table;
+}
+
+inline MMBoardMap::Table MMBoardMap::Default(){
+  Table table;
+  for(int i = 0; i < MAXID; i++)
+    table.index[i] = -1;
+  for(int i = 0; i < NBOARD; i++)
+    table.mmfe8[i] = -1;
+  table.index[2] = 0;
+  table.index[3] = 1;
+  table.mmfe8[0] = 2;
+  table.mmfe8[1] = 3;
+  table.Nboard = 2;
+  return table;
+}
+
+inline int MMBoardMap::Index(int mmfe8){
+  if(mmfe8 < 0 || mmfe8 >= MAXID)
+    return -1;
+  return Get().index[mmfe8];
+}
+
+inline int MMBoardMap::Slot(int mmfe8){
+  int index = Index(mmfe8);
+  return index < 0 ? NBOARD : index;
+}
+
+inline int MMBoardMap::MMFE8(int index){
+  if(index < 0 || index >= NBOARD)
+    return -1;
+  return Get().mmfe8[index];
+}
+
+inline int MMBoardMap::GetNBoards(){
+  return Get().Nboard;
+}
+
+inline void MMBoardMap::SetIndex(int mmfe8, int index){
+  if(mmfe8 < 0 || mmfe8 >= MAXID || index < 0 || index >= NBOARD){
+    std::cout << "MMBoardMap ERROR: cannot map board " << mmfe8
+              << " to layer " << index << std::endl;
+    return;
+  }
+  Table& table = Get();
+  int old = table.mmfe8[index];
+  if(old >= 0)
+    table.index[old] = -1;
+  if(table.index[mmfe8] >= 0)
+    table.mmfe8[table.index[mmfe8]] = -1;
+  table.index[mmfe8] = index;
+  table.mmfe8[index] = mmfe8;
+
+  table.Nboard = 0;
+  for(int i = 0; i < NBOARD; i++)
+    if(table.mmfe8[i] >= 0)
+      table.Nboard = i+1;
+}
+
+inline void MMBoardMap::Clear(){
+  Table& table = Get();
+  for(int i = 0; i < MAXID; i++)
+    table.index[i] = -1;
+  for(int i = 0; i < NBOARD; i++)
+    table.mmfe8[i] = -1;
+  table.Nboard = 0;
+}
+
+inline void MMBoardMap::SetDefault(){
+  Get() = Default();
+}
+
+#endif
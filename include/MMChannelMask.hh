@@ -0,0 +1,237 @@
+///
+///  \file   MMChannelMask.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMChannelMask_HH
+#define MMChannelMask_HH
+
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+
+#include "include/MMBoardMap.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMChannelMask class
+//
+// Masked channels as one 64-bit word per
+// (MMFE8 id, VMM), so the decoder tests a
+// channel with a single bit read and masked
+// hits are never built.
+//
+// Hot and dead channels are found from the
+// hit counts of a sample of events (Count,
+// then Flag): per board, a channel is hot if
+// its count is above hot_factor x the median
+// count of the board's channels, and dead if
+// it is at most dead_factor x that median
+// (only in VMMs read out in the sample). The
+// trigger channel 63 is never flagged
+///////////////////////////////////////////////
+
+class MMChannelMask {
+
+public:
+  static const int NCH = 64;
+
+  MMChannelMask();
+  ~MMChannelMask() {}
+
+  bool IsMasked(int mmfe8, int vmm, int ch) const;
+  void Mask(int mmfe8, int vmm, int ch);
+  void Unmask(int mmfe8, int vmm, int ch);
+  void Clear();
+
+  // known bad channels: 61 and 62 of board 3
+  void SetDefault();
+
+  int GetNMasked() const;
+  int GetNMasked(int mmfe8) const;
+
+  // occupancy pre-pass
+  void ResetCounts();
+  void Count(int mmfe8, int vmm, int ch);
+  void CountEvent();
+  // masks the hot and dead channels, returns how many
+  int Flag(double hot_factor = 10., double dead_factor = 0.05);
+  int GetNHot() const;
+  int GetNDead() const;
+
+  void Print() const;
+
+private:
+  static const int NVMM = MMBoardMap::NVMM;
+  static const int MAXID = MMBoardMap::MAXID;
+
+  uint64_t m_mask[MAXID][NVMM];
+
+  // sparse: boards seen in the sample only
+  vector<int> m_boards;
+  vector<vector<int> > m_counts;  // [board][vmm*NCH + ch]
+  vector<int> m_board_slot;       // id -> row of m_counts
+  int m_Nevent;
+  int m_Nhot;
+  int m_Ndead;
+  vector<int> m_hot;   // flattened (id, vmm, ch) of the last Flag()
+  vector<int> m_dead;
+};
+
+inline MMChannelMask::MMChannelMask(){
+  Clear();
+  ResetCounts();
+}
+
+inline bool MMChannelMask::IsMasked(int mmfe8, int vmm, int ch) const {
+  if(mmfe8 < 0 || mmfe8 >= MAXID || vmm < 0 || vmm >= NVMM || ch < 0 || ch >= NCH)
+    return false;
+  return (m_mask[mmfe8][vmm] >> ch) & 1;
+}
+
+inline void MMChannelMask::Mask(int mmfe8, int vmm, int ch){
+  if(mmfe8 < 0 || mmfe8 >= MAXID || vmm < 0 || vmm >= NVMM || ch < 0 || ch >= NCH)
+    return;
+  m_mask[mmfe8][vmm] |= (uint64_t(1) << ch);
+}
+
+inline void MMChannelMask::Unmask(int mmfe8, int vmm, int ch){
+  if(mmfe8 < 0 || mmfe8 >= MAXID || vmm < 0 || vmm >= NVMM || ch < 0 || ch >= NCH)
+    return;
+  m_mask[mmfe8][vmm] &= ~(uint64_t(1) << ch);
+}
+
+inline void MMChannelMask::Clear(){
+  for(int b = 0; b < MAXID; b++)
+    for(int v = 0; v < NVMM; v++)
+      m_mask[b][v] = 0;
+}
+
+inline void MMChannelMask::SetDefault(){
+  for(int v = 0; v < NVMM; v++){
+    Mask(3, v, 61);
+    Mask(3, v, 62);
+  }
+}
+
+inline int MMChannelMask::GetNMasked(int mmfe8) const {
+  if(mmfe8 < 0 || mmfe8 >= MAXID)
+    return 0;
+  int N = 0;
+  for(int v = 0; v < NVMM; v++)
+    N += __builtin_popcountll(m_mask[mmfe8][v]);
+  return N;
+}
+
+inline int MMChannelMask::GetNMasked() const {
+  int N = 0;
+  for(int b = 0; b < MAXID; b++)
+    N += GetNMasked(b);
+  return N;
+}
+
+inline void MMChannelMask::ResetCounts(){
+  m_boards.clear();
+  m_counts.clear();
+  m_board_slot.assign(MAXID, -1);
+  m_Nevent = 0;
+  m_Nhot = 0;
+  m_Ndead = 0;
+  m_hot.clear();
+  m_dead.clear();
+}
+
+inline void MMChannelMask::Count(int mmfe8, int vmm, int ch){
+  if(mmfe8 < 0 || mmfe8 >= MAXID || vmm < 0 || vmm >= NVMM || ch < 0 || ch >= NCH)
+    return;
+  int slot = m_board_slot[mmfe8];
+  if(slot < 0){
+    slot = m_boards.size();
+    m_board_slot[mmfe8] = slot;
+    m_boards.push_back(mmfe8);
+    m_counts.push_back(vector<int>(NVMM*NCH, 0));
+  }
+  m_counts[slot][vmm*NCH + ch]++;
+}
+
+inline void MMChannelMask::CountEvent(){
+  m_Nevent++;
+}
+
+inline int MMChannelMask::Flag(double hot_factor, double dead_factor){
+  m_Nhot = 0;
+  m_Ndead = 0;
+  m_hot.clear();
+  m_dead.clear();
+
+  int Nboard = m_boards.size();
+  for(int s = 0; s < Nboard; s++){
+    const vector<int>& counts = m_counts[s];
+
+    // channels of the VMMs read out in the sample
+    vector<char> read(NVMM, 0);
+    vector<int> occupied;
+    for(int v = 0; v < NVMM; v++){
+      for(int c = 0; c < NCH-1; c++)
+        if(counts[v*NCH + c] > 0)
+          read[v] = 1;
+      if(!read[v])
+        continue;
+      for(int c = 0; c < NCH-1; c++)
+        occupied.push_back(counts[v*NCH + c]);
+    }
+    if(occupied.empty())
+      continue;
+    nth_element(occupied.begin(), occupied.begin() + occupied.size()/2, occupied.end());
+    double median = occupied[occupied.size()/2];
+    if(median <= 0.)
+      continue;
+
+    for(int v = 0; v < NVMM; v++){
+      if(!read[v])
+        continue;
+      for(int c = 0; c < NCH-1; c++){
+        int count = counts[v*NCH + c];
+        int id = (m_boards[s]*NVMM + v)*NCH + c;
+        if(count > hot_factor*median){
+          m_hot.push_back(id);
+          m_Nhot++;
+        } else if(dead_factor > 0. && count <= dead_factor*median){
+          m_dead.push_back(id);
+          m_Ndead++;
+        } else {
+          continue;
+        }
+        Mask(m_boards[s], v, c);
+      }
+    }
+  }
+  return m_Nhot + m_Ndead;
+}
+
+inline int MMChannelMask::GetNHot() const {
+  return m_Nhot;
+}
+
+inline int MMChannelMask::GetNDead() const {
+  return m_Ndead;
+}
+
+inline void MMChannelMask::Print() const {
+  cout << "MMChannelMask: " << GetNMasked() << " masked channels";
+  if(m_Nevent > 0)
+    cout << ", " << m_Nhot << " hot and " << m_Ndead << " dead in " << m_Nevent << " sampled events";
+  cout << endl;
+  for(int id: m_hot)
+    cout << "  hot:  board " << id/(NVMM*NCH) << " VMM " << (id/NCH)%NVMM << " channel " << id%NCH << endl;
+  for(int id: m_dead)
+    cout << "  dead: board " << id/(NVMM*NCH) << " VMM " << (id/NCH)%NVMM << " channel " << id%NCH << endl;
+}
+
+#endif
@@ -0,0 +1,223 @@
+///
+///  \file   MMChannelSketch.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMChannelSketch_HH
+#define MMChannelSketch_HH
+
+#include <string>
+#include <vector>
+
+#include <TString.h>
+#include <TTree.h>
+#include <TGraph.h>
+#include <TGraphErrors.h>
+
+#include "include/MMQuantileSketch.hh"
+#include "include/MMBoardMap.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMChannelSketch class
+//
+// One MMQuantileSketch per (board, strip) of
+// a hit quantity, in place of a dense strip
+// vs value TH2D. Write() stores the sketch
+// state as a TTree (one row per centroid),
+// which Read() merges back, and per board
+// summary graphs vs strip:
+//
+//   <name>_median_<board>  median, error = 68% half width
+//   <name>_mean_<board>    mean, error = RMS
+//   <name>_q05_<board>     5% quantile
+//   <name>_q95_<board>     95% quantile
+///////////////////////////////////////////////
+
+class MMChannelSketch {
+
+public:
+  // strips of an MMFE8 (VMM*64 + channel)
+  static const int NSTRIP = 64*MMBoardMap::NVMM;
+
+  MMChannelSketch(const string& name, const string& title, double compression = 50.);
+  ~MMChannelSketch() {}
+
+  const string& GetName() const;
+  const string& GetTitle() const;
+
+  // board is the layer index (MMFE8Index)
+  void Fill(int board, double strip, double x);
+  void Merge(const MMChannelSketch& other);
+
+  MMQuantileSketch& Get(int board, int strip);
+
+  // state tree and summary graphs, into the current directory
+  void Write();
+
+  // merges the state tree written by Write()
+  bool Read(TTree* tree);
+
+private:
+  string m_name;
+  string m_title;
+  vector<MMQuantileSketch> m_sketch;
+
+  void WriteGraphs(int board);
+};
+
+inline MMChannelSketch::MMChannelSketch(const string& name, const string& title, double compression)
+  : m_name(name), m_title(title),
+    m_sketch(MMBoardMap::NBOARD*NSTRIP, MMQuantileSketch(compression)) {}
+
+inline const string& MMChannelSketch::GetName() const {
+  return m_name;
+}
+
+inline const string& MMChannelSketch::GetTitle() const {
+  return m_title;
+}
+
+inline void MMChannelSketch::Fill(int board, double strip, double x){
+  int s = int(strip);
+  if(board < 0 || board >= MMBoardMap::NBOARD || s < 0 || s >= NSTRIP)
+    return;
+  m_sketch[board*NSTRIP + s].Add(x);
+}
+
+inline void MMChannelSketch::Merge(const MMChannelSketch& other){
+  int N = m_sketch.size();
+  for(int i = 0; i < N; i++)
+    m_sketch[i].Merge(other.m_sketch[i]);
+}
+
+inline MMQuantileSketch& MMChannelSketch::Get(int board, int strip){
+  return m_sketch[board*NSTRIP + strip];
+}
+
+inline void MMChannelSketch::Write(){
+  int board, strip;
+  double mean, weight, min, max, sum, sum2;
+  TTree* tree = new TTree(m_name.c_str(), m_title.c_str());
+  tree->Branch("board",  &board,  "board/I");
+  tree->Branch("strip",  &strip,  "strip/I");
+  tree->Branch("mean",   &mean,   "mean/D");
+  tree->Branch("weight", &weight, "weight/D");
+  tree->Branch("min",    &min,    "min/D");
+  tree->Branch("max",    &max,    "max/D");
+  tree->Branch("sum",    &sum,    "sum/D");
+  tree->Branch("sum2",   &sum2,   "sum2/D");
+
+  for(board = 0; board < MMBoardMap::NBOARD; board++){
+    for(strip = 0; strip < NSTRIP; strip++){
+      MMQuantileSketch& sketch = Get(board, strip);
+      if(sketch.GetN() == 0.)
+        continue;
+      sketch.Compress();
+      min = sketch.Min();
+      max = sketch.Max();
+      // moments on the first row of the strip only
+      sum  = sketch.Sum();
+      sum2 = sketch.Sum2();
+      int Nc = sketch.GetNCentroids();
+      for(int c = 0; c < Nc; c++){
+        mean   = sketch.CentroidMean(c);
+        weight = sketch.CentroidWeight(c);
+        tree->Fill();
+        sum  = 0.;
+        sum2 = 0.;
+      }
+    }
+  }
+  tree->Write();
+  delete tree;
+
+  for(int b = 0; b < MMBoardMap::NBOARD; b++)
+    WriteGraphs(b);
+}
+
+inline void MMChannelSketch::WriteGraphs(int b){
+  vector<double> x, ex, median, width, mean, rms, q05, q95;
+  for(int s = 0; s < NSTRIP; s++){
+    MMQuantileSketch& sketch = Get(b, s);
+    if(sketch.GetN() == 0.)
+      continue;
+    x.push_back(s);
+    ex.push_back(0.);
+    median.push_back(sketch.Quantile(0.5));
+    width.push_back((sketch.Quantile(0.84) - sketch.Quantile(0.16))/2.);
+    mean.push_back(sketch.Mean());
+    rms.push_back(sketch.RMS());
+    q05.push_back(sketch.Quantile(0.05));
+    q95.push_back(sketch.Quantile(0.95));
+  }
+  int N = x.size();
+  if(N == 0)
+    return;
+
+  string axes = ";strip number;" + m_title;
+  TGraphErrors* g_median = new TGraphErrors(N, &x[0], &median[0], &ex[0], &width[0]);
+  TGraphErrors* g_mean   = new TGraphErrors(N, &x[0], &mean[0],   &ex[0], &rms[0]);
+  TGraph*       g_q05    = new TGraph(N, &x[0], &q05[0]);
+  TGraph*       g_q95    = new TGraph(N, &x[0], &q95[0]);
+  g_median->SetNameTitle(Form("%s_median_%i", m_name.c_str(), b), axes.c_str());
+  g_mean  ->SetNameTitle(Form("%s_mean_%i",   m_name.c_str(), b), axes.c_str());
+  g_q05   ->SetNameTitle(Form("%s_q05_%i",    m_name.c_str(), b), axes.c_str());
+  g_q95   ->SetNameTitle(Form("%s_q95_%i",    m_name.c_str(), b), axes.c_str());
+  for(TGraph* g: {(TGraph*) g_median, (TGraph*) g_mean, g_q05, g_q95}){
+    g->Write();
+    delete g;
+  }
+}
+
+inline bool MMChannelSketch::Read(TTree* tree){
+  if(!tree || !tree->GetBranch("mean"))
+    return false;
+  int board, strip;
+  double mean, weight, min, max, sum, sum2;
+  tree->SetBranchAddress("board",  &board);
+  tree->SetBranchAddress("strip",  &strip);
+  tree->SetBranchAddress("mean",   &mean);
+  tree->SetBranchAddress("weight", &weight);
+  tree->SetBranchAddress("min",    &min);
+  tree->SetBranchAddress("max",    &max);
+  tree->SetBranchAddress("sum",    &sum);
+  tree->SetBranchAddress("sum2",   &sum2);
+
+  // rows of a strip are contiguous
+  vector<double> means, weights;
+  int cur_board = -1, cur_strip = -1;
+  double cur_min = 0., cur_max = 0., cur_sum = 0., cur_sum2 = 0.;
+  Long64_t N = tree->GetEntries();
+  for(Long64_t i = 0; i <= N; i++){
+    if(i < N)
+      tree->GetEntry(i);
+    if(i == N || board != cur_board || strip != cur_strip){
+      if(cur_board >= 0 && cur_board < MMBoardMap::NBOARD && cur_strip >= 0 && cur_strip < NSTRIP)
+        Get(cur_board, cur_strip).AddCentroids(means, weights, cur_min, cur_max, cur_sum, cur_sum2);
+      if(i == N)
+        break;
+      means.clear();
+      weights.clear();
+      cur_board = board;
+      cur_strip = strip;
+      cur_min  = min;
+      cur_max  = max;
+      cur_sum  = 0.;
+      cur_sum2 = 0.;
+    }
+    means.push_back(mean);
+    weights.push_back(weight);
+    cur_sum  += sum;
+    cur_sum2 += sum2;
+  }
+  tree->ResetBranchAddresses();
+  return true;
+}
+
+#endif
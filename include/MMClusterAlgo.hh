@@ -13,15 +13,21 @@
 
 #include "include/MMClusterList.hh"
 
+using namespace std;
+
 class MMClusterAlgo {
 
 public:
   MMClusterAlgo();
   
-  ~MMClusterAlgo() {}
+  virtual ~MMClusterAlgo() {}
+
+  // virtual function must be implemented in derived classes;
+  // good[i] is IsGoodHit(hits[i]), evaluated beforehand
+  virtual MMClusterList Cluster(const MMFE8Hits& hits, const vector<char>& good) = 0;
 
-  // virtual function must be implemented in derived classes
-  virtual MMClusterList Cluster(const MMFE8Hits& hits) = 0;
+  // evaluates IsGoodHit once per hit and clusters
+  virtual MMClusterList Cluster(const MMFE8Hits& hits);
   
   void SetMaxBCIDDiff(int diff);
   void SetMinBCIDDiff(int diff);
@@ -30,7 +36,8 @@ public:
   void SetMaxTimeDiff(double max_tdo);
   void SetEventPadTime(double pad_time);
 
-  bool IsGoodHit(const MMHit& hit);
+  bool IsGoodHit(const MMHit& hit) const;
+  void GoodHitMask(const MMFE8Hits& hits, vector<char>& good) const;
 
 private:
   int m_max_BCID_diff;
@@ -39,6 +46,8 @@ private:
 
   double m_max_time_diff;
   double m_pad_time;
+
+  vector<char> m_good;
   
 };
 
@@ -72,7 +81,19 @@ inline void MMClusterAlgo::SetEventPadTime(double pad_time){
   m_pad_time = pad_time;
 }
 
-inline bool MMClusterAlgo::IsGoodHit(const MMHit& hit){
+inline MMClusterList MMClusterAlgo::Cluster(const MMFE8Hits& hits){
+  GoodHitMask(hits, m_good);
+  return Cluster(hits, m_good);
+}
+
+inline void MMClusterAlgo::GoodHitMask(const MMFE8Hits& hits, vector<char>& good) const {
+  int Nhit = hits.GetNHits();
+  good.resize(Nhit);
+  for(int i = 0; i < Nhit; i++)
+    good[i] = IsGoodHit(hits[i]);
+}
+
+inline bool MMClusterAlgo::IsGoodHit(const MMHit& hit) const {
   if(!hit.IsChargeCalib())
     return false;
   if(!hit.IsTimeCalib())
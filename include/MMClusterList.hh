@@ -65,6 +65,7 @@ inline MMClusterList MMClusterList::operator = (const MMClusterList& cl){
   if (this != &cl){
     for (int i = 0; i <    GetNCluster(); i++)
       delete m_clusters[i];
+    m_clusters.clear();
     for (int i = 0; i < cl.GetNCluster(); i++)
       AddCluster(cl[i]);
   }
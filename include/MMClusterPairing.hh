@@ -0,0 +1,191 @@
+///
+///  \file   MMClusterPairing.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMClusterPairing_HH
+#define MMClusterPairing_HH
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "include/MMClusterList.hh"
+#include "include/MMBoardMap.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMClusterPairing class
+//
+// Pairs of clusters of layer 0 and layer 1
+// with |x_0 - x_1 + offset| within a window,
+// for events with several clusters per board.
+// The barycentres in the fiducial range are
+// sorted on each board and swept with two
+// pointers: the window start only moves
+// forward, so finding all n pairs costs
+// O(N log N + n). The best pair is the one
+// with the smallest |dx|
+///////////////////////////////////////////////
+
+class MMClusterPairing {
+
+public:
+  // window on |dx| [mm], strip pitch [mm]
+  MMClusterPairing(double window = 4., double pitch = 0.4);
+  ~MMClusterPairing();
+
+  void SetWindow(double window);
+  void SetFiducial(double x_min, double x_max);
+
+  // dx = x_0 - x_1 + offset + offset_slope*x_1,
+  // returns the number of pairs
+  int Pair(const vector<MMClusterList>& clusters_perboard,
+           double offset = 0., double offset_slope = 0.);
+
+  int GetNPairs() const;
+  // index of the smallest |dx|, -1 if no pair
+  int Best() const;
+
+  double DX(int k) const;
+  double X0(int k) const;
+  double X1(int k) const;
+  const MMCluster& Cluster0(int k) const;
+  const MMCluster& Cluster1(int k) const;
+
+  // fiducial clusters of the last event per layer
+  int GetNClusters(int layer) const;
+
+private:
+  struct Entry {
+    double x;
+    const MMCluster* clus;
+    bool operator < (const Entry& other) const { return x < other.x; }
+  };
+  struct ClusterPair {
+    int i0;
+    int i1;
+    double dx;
+  };
+
+  double m_window;
+  double m_pitch;
+  double m_x_min;
+  double m_x_max;
+  int m_best;
+
+  vector<Entry> m_layer[2];
+  vector<ClusterPair> m_pairs;
+};
+
+inline MMClusterPairing::MMClusterPairing(double window, double pitch){
+  m_window = window;
+  m_pitch = pitch;
+  m_x_min = -1e9;
+  m_x_max =  1e9;
+  m_best = -1;
+}
+
+inline MMClusterPairing::~MMClusterPairing() {}
+
+inline void MMClusterPairing::SetWindow(double window){
+  m_window = window;
+}
+
+inline void MMClusterPairing::SetFiducial(double x_min, double x_max){
+  m_x_min = x_min;
+  m_x_max = x_max;
+}
+
+inline int MMClusterPairing::Pair(const vector<MMClusterList>& clusters_perboard,
+                                  double offset, double offset_slope){
+  m_layer[0].clear();
+  m_layer[1].clear();
+  m_pairs.clear();
+  m_best = -1;
+
+  for(const MMClusterList& list: clusters_perboard)
+    for(int c = 0; c < list.GetNCluster(); c++){
+      int layer = MMBoardMap::Index(list[c].MMFE8());
+      if(layer < 0 || layer > 1)
+        continue;
+      Entry entry;
+      entry.x = list[c].Channel()*m_pitch;
+      entry.clus = &list[c];
+      if(entry.x < m_x_min || entry.x > m_x_max)
+        continue;
+      m_layer[layer].push_back(entry);
+    }
+  if(m_layer[0].empty() || m_layer[1].empty())
+    return 0;
+  std::sort(m_layer[0].begin(), m_layer[0].end());
+  std::sort(m_layer[1].begin(), m_layer[1].end());
+
+  // x_0 + offset(x_1) within the window of x_1: with the
+  // slope term the window is widened by its largest value
+  // on the board and the pairs are checked on the exact dx
+  const vector<Entry>& A = m_layer[0];
+  const vector<Entry>& B = m_layer[1];
+  double slack = fabs(offset_slope)*std::max(fabs(B.front().x), fabs(B.back().x));
+  size_t lo = 0;
+  for(size_t i = 0; i < A.size(); i++){
+    double a = A[i].x + offset;
+    while(lo < B.size() && B[lo].x < a - m_window - slack)
+      lo++;
+    for(size_t j = lo; j < B.size() && B[j].x <= a + m_window + slack; j++){
+      double dx = a - B[j].x + offset_slope*B[j].x;
+      if(fabs(dx) > m_window)
+        continue;
+      ClusterPair pair;
+      pair.i0 = i;
+      pair.i1 = j;
+      pair.dx = dx;
+      if(m_best < 0 || fabs(dx) < fabs(m_pairs[m_best].dx))
+        m_best = m_pairs.size();
+      m_pairs.push_back(pair);
+    }
+  }
+  return m_pairs.size();
+}
+
+inline int MMClusterPairing::GetNPairs() const {
+  return m_pairs.size();
+}
+
+inline int MMClusterPairing::Best() const {
+  return m_best;
+}
+
+inline double MMClusterPairing::DX(int k) const {
+  return m_pairs[k].dx;
+}
+
+inline double MMClusterPairing::X0(int k) const {
+  return m_layer[0][m_pairs[k].i0].x;
+}
+
+inline double MMClusterPairing::X1(int k) const {
+  return m_layer[1][m_pairs[k].i1].x;
+}
+
+inline const MMCluster& MMClusterPairing::Cluster0(int k) const {
+  return *m_layer[0][m_pairs[k].i0].clus;
+}
+
+inline const MMCluster& MMClusterPairing::Cluster1(int k) const {
+  return *m_layer[1][m_pairs[k].i1].clus;
+}
+
+inline int MMClusterPairing::GetNClusters(int layer) const {
+  if(layer < 0 || layer > 1)
+    return 0;
+  return m_layer[layer].size();
+}
+
+#endif
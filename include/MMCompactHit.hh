@@ -0,0 +1,547 @@
+///
+///  \file   MMCompactHit.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMCompactHit_HH
+#define MMCompactHit_HH
+
+#include <stdint.h>
+#include <unordered_map>
+
+#include "include/MMEventHits.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMHitCalibTable class
+//
+// Calibration constants of every channel
+// seen so far, stored once per channel and
+// referenced from the compact hits by index
+// instead of being copied into every hit
+///////////////////////////////////////////////
+
+class MMHitCalibTable {
+
+public:
+  MMHitCalibTable() {}
+  ~MMHitCalibTable() {}
+
+  // index of the hit's channel, adding its constants if new
+  uint32_t Index(const MMHit& hit);
+
+  int GetNChannels() const;
+  size_t GetNBytes() const;
+
+  double PDOGain(uint32_t index) const;
+  double PDOPed(uint32_t index) const;
+  double TDOGain(uint32_t index) const;
+  double TDOPed(uint32_t index) const;
+  double TrigTDOGain(uint32_t index) const;
+  double TrigTDOPed(uint32_t index) const;
+
+private:
+  struct Constants {
+    double PDO_gain;
+    double PDO_ped;
+    double TDO_gain;
+    double TDO_ped;
+    double trig_TDO_gain;
+    double trig_TDO_ped;
+  };
+
+  unordered_map<uint32_t, uint32_t> m_key_to_index;
+  vector<Constants> m_constants;
+};
+
+///////////////////////////////////////////////
+// MMCompactHit class
+//
+// 32-byte hit record: raw quantities in
+// small integers, charge and time as float,
+// calibration constants by channel index.
+// Duplicates of a channel are kept in a
+// separate array of the event, the head hit
+// stores where they start and how many
+///////////////////////////////////////////////
+
+class MMCompactHit {
+
+public:
+  enum Flags {
+    kChargeCalib = 1,
+    kTimeCalib   = 2,
+    kTrigCalib   = 4
+  };
+
+  MMCompactHit();
+  MMCompactHit(const MMHit& hit, uint32_t calib);
+  ~MMCompactHit() {}
+
+  uint32_t m_calib;
+  float    m_charge;
+  float    m_time;
+  int16_t  m_PDO;
+  int16_t  m_TDO;
+  int16_t  m_BCID;
+  int16_t  m_trigBCID;
+  int16_t  m_trigTDO;
+  int16_t  m_FIFOcount;
+  uint16_t m_first_dup;
+  uint8_t  m_Ndup;
+  uint8_t  m_MMFE8;
+  uint8_t  m_VMM;
+  uint8_t  m_CH;
+  uint8_t  m_flags;
+  uint8_t  m_pad;
+};
+
+static_assert(sizeof(MMCompactHit) == 32, "MMCompactHit must stay 32 bytes");
+
+class MMCompactEventHits;
+
+///////////////////////////////////////////////
+// MMCompactHitRef class
+//
+// Compatibility view of a compact hit with
+// the MMHit accessors, so code written
+// against MMHit / MMLinkedHit reads the
+// compact event unchanged
+///////////////////////////////////////////////
+
+class MMCompactHitRef {
+
+public:
+  MMCompactHitRef(const MMCompactHit& hit, const MMCompactEventHits& event);
+
+  int MMFE8() const;
+  int MMFE8Index() const;
+  int VMM() const;
+  double Channel() const;
+  double VMMChannel() const;
+  int PDO() const;
+  int TDO() const;
+  int BCID() const;
+  int SuspiciousBCID() const;
+  int TrigBCID() const;
+  double TrigTDO() const;
+  double TrigTime() const;
+  int FIFOcount() const;
+  int RunNumber() const;
+
+  double Charge() const;
+  double Time() const;
+  double DriftTime(double T, int recipe) const;
+  double DeltaBC() const;
+  double TDOGain() const;
+  double TDOPed() const;
+  double TrigTDOGain() const;
+  double TrigTDOPed() const;
+  double PDOGain() const;
+  double PDOPed() const;
+
+  bool IsChargeCalib() const;
+  bool IsTimeCalib() const;
+  bool IsTrigCalib() const;
+
+  // as MMLinkedHit: 1 + number of duplicates
+  int GetNHits() const;
+  MMCompactHitRef GetDuplicate(int idup) const;
+
+  // full MMHit copy (charge and time at float precision)
+  MMHit ToMMHit() const;
+
+private:
+  const MMCompactHit* m_hit;
+  const MMCompactEventHits* m_event;
+};
+
+///////////////////////////////////////////////
+// MMCompactEventHits class
+//
+// All hits of an event in one contiguous
+// array, boards in MMEventHits order and
+// hits within a board in MMFE8Hits order
+///////////////////////////////////////////////
+
+class MMCompactEventHits {
+
+public:
+  MMCompactEventHits(MMHitCalibTable* calib);
+  ~MMCompactEventHits() {}
+
+  void Fill(const MMEventHits& evt_hits);
+
+  int GetNBoards() const;
+  int MMFE8(int iboard) const;
+  int GetNHits(int iboard) const;
+  int GetNHits() const;
+  int RunNumber() const;
+  MMCompactHitRef Get(int iboard, int ihit) const;
+
+  const MMHitCalibTable& CalibTable() const;
+
+  // heap + object bytes used by this event (calibration table excluded)
+  size_t GetNBytes() const;
+
+  // same estimate for an MMEventHits (objects and pointer
+  // arrays, allocator overhead not counted)
+  static size_t GetNBytes(const MMEventHits& evt_hits);
+
+private:
+  MMHitCalibTable* m_calib;
+  int m_RunNumber;
+  vector<MMCompactHit> m_hits;
+  vector<MMCompactHit> m_dups;
+  vector<int> m_board_first; // Nboard+1 offsets into m_hits
+
+  void Append(vector<MMCompactHit>& hits, const MMHit& hit);
+
+  friend class MMCompactHitRef;
+};
+
+inline uint32_t MMHitCalibTable::Index(const MMHit& hit){
+  uint32_t key = (uint32_t(hit.MMFE8() & 0xff) << 16) |
+                 (uint32_t(hit.VMM() & 0xff) << 8) |
+                  uint32_t(int(hit.VMMChannel()) & 0xff);
+  auto it = m_key_to_index.find(key);
+  if(it != m_key_to_index.end())
+    return it->second;
+
+  Constants c;
+  c.PDO_gain = hit.PDOGain();
+  c.PDO_ped  = hit.PDOPed();
+  c.TDO_gain = hit.TDOGain();
+  c.TDO_ped  = hit.TDOPed();
+  c.trig_TDO_gain = hit.TrigTDOGain();
+  c.trig_TDO_ped  = hit.TrigTDOPed();
+
+  uint32_t index = m_constants.size();
+  m_constants.push_back(c);
+  m_key_to_index[key] = index;
+  return index;
+}
+
+inline int MMHitCalibTable::GetNChannels() const {
+  return int(m_constants.size());
+}
+
+inline size_t MMHitCalibTable::GetNBytes() const {
+  return sizeof(MMHitCalibTable) + m_constants.capacity()*sizeof(Constants) +
+    m_key_to_index.size()*(2*sizeof(uint32_t) + sizeof(void*));
+}
+
+inline double MMHitCalibTable::PDOGain(uint32_t index) const {
+  return m_constants[index].PDO_gain;
+}
+
+inline double MMHitCalibTable::PDOPed(uint32_t index) const {
+  return m_constants[index].PDO_ped;
+}
+
+inline double MMHitCalibTable::TDOGain(uint32_t index) const {
+  return m_constants[index].TDO_gain;
+}
+
+inline double MMHitCalibTable::TDOPed(uint32_t index) const {
+  return m_constants[index].TDO_ped;
+}
+
+inline double MMHitCalibTable::TrigTDOGain(uint32_t index) const {
+  return m_constants[index].trig_TDO_gain;
+}
+
+inline double MMHitCalibTable::TrigTDOPed(uint32_t index) const {
+  return m_constants[index].trig_TDO_ped;
+}
+
+inline MMCompactHit::MMCompactHit(){
+  m_calib = 0;
+  m_charge = -1;
+  m_time = -1;
+  m_PDO = -1;
+  m_TDO = -1;
+  m_BCID = -1;
+  m_trigBCID = -1;
+  m_trigTDO = -1;
+  m_FIFOcount = -1;
+  m_first_dup = 0;
+  m_Ndup = 0;
+  m_MMFE8 = 0;
+  m_VMM = 0;
+  m_CH = 0;
+  m_flags = 0;
+  m_pad = 0;
+}
+
+inline MMCompactHit::MMCompactHit(const MMHit& hit, uint32_t calib){
+  m_calib = calib;
+  m_charge = hit.Charge();
+  m_time = hit.Time();
+  m_PDO = hit.PDO();
+  m_TDO = hit.TDO();
+  m_BCID = hit.BCID();
+  m_trigBCID = hit.TrigBCID();
+  m_trigTDO = int(hit.TrigTDO());
+  m_FIFOcount = hit.FIFOcount();
+  m_first_dup = 0;
+  m_Ndup = 0;
+  m_MMFE8 = hit.MMFE8();
+  m_VMM = hit.VMM();
+  m_CH = int(hit.VMMChannel());
+  m_flags = 0;
+  if(hit.IsChargeCalib())
+    m_flags |= kChargeCalib;
+  if(hit.IsTimeCalib())
+    m_flags |= kTimeCalib;
+  if(hit.IsTrigCalib())
+    m_flags |= kTrigCalib;
+  m_pad = 0;
+}
+
+inline MMCompactHitRef::MMCompactHitRef(const MMCompactHit& hit, const MMCompactEventHits& event){
+  m_hit = &hit;
+  m_event = &event;
+}
+
+inline int MMCompactHitRef::MMFE8() const {
+  return m_hit->m_MMFE8;
+}
+
+inline int MMCompactHitRef::MMFE8Index() const {
+  return MMBoardMap::Index(m_hit->m_MMFE8);
+}
+
+inline int MMCompactHitRef::VMM() const {
+  return m_hit->m_VMM;
+}
+
+inline double MMCompactHitRef::Channel() const {
+  return std::max(-1., 64.*m_hit->m_VMM + m_hit->m_CH);
+}
+
+inline double MMCompactHitRef::VMMChannel() const {
+  return m_hit->m_CH;
+}
+
+inline int MMCompactHitRef::PDO() const {
+  return m_hit->m_PDO;
+}
+
+inline int MMCompactHitRef::TDO() const {
+  return m_hit->m_TDO;
+}
+
+inline int MMCompactHitRef::BCID() const {
+  return m_hit->m_BCID;
+}
+
+inline int MMCompactHitRef::SuspiciousBCID() const {
+  return m_hit->m_BCID % 4 == 1;
+}
+
+inline int MMCompactHitRef::TrigBCID() const {
+  return m_hit->m_trigBCID;
+}
+
+inline double MMCompactHitRef::TrigTDO() const {
+  return m_hit->m_trigTDO;
+}
+
+inline double MMCompactHitRef::TrigTime() const {
+  return (TrigTDO()-TrigTDOGain())/TrigTDOPed();
+}
+
+inline int MMCompactHitRef::FIFOcount() const {
+  return m_hit->m_FIFOcount;
+}
+
+inline int MMCompactHitRef::RunNumber() const {
+  return m_event->RunNumber();
+}
+
+inline double MMCompactHitRef::Charge() const {
+  return m_hit->m_charge;
+}
+
+inline double MMCompactHitRef::Time() const {
+  return m_hit->m_time;
+}
+
+inline double MMCompactHitRef::DriftTime(double T, int recipe) const {
+  if (SuspiciousBCID() != 1 or recipe != 2) {
+    return T - 25*DeltaBC() - Time();
+  }
+  else {
+    return T - 25* (DeltaBC() + 0.5) - Time();
+  }
+}
+
+inline double MMCompactHitRef::DeltaBC() const {
+  return TrigBCID() - TrigTime()/25.0 - BCID();
+}
+
+inline double MMCompactHitRef::TDOGain() const {
+  return m_event->m_calib->TDOGain(m_hit->m_calib);
+}
+
+inline double MMCompactHitRef::TDOPed() const {
+  return m_event->m_calib->TDOPed(m_hit->m_calib);
+}
+
+inline double MMCompactHitRef::TrigTDOGain() const {
+  return m_event->m_calib->TrigTDOGain(m_hit->m_calib);
+}
+
+inline double MMCompactHitRef::TrigTDOPed() const {
+  return m_event->m_calib->TrigTDOPed(m_hit->m_calib);
+}
+
+inline double MMCompactHitRef::PDOGain() const {
+  return m_event->m_calib->PDOGain(m_hit->m_calib);
+}
+
+inline double MMCompactHitRef::PDOPed() const {
+  return m_event->m_calib->PDOPed(m_hit->m_calib);
+}
+
+inline bool MMCompactHitRef::IsChargeCalib() const {
+  return m_hit->m_flags & MMCompactHit::kChargeCalib;
+}
+
+inline bool MMCompactHitRef::IsTimeCalib() const {
+  return m_hit->m_flags & MMCompactHit::kTimeCalib;
+}
+
+inline bool MMCompactHitRef::IsTrigCalib() const {
+  return m_hit->m_flags & MMCompactHit::kTrigCalib;
+}
+
+inline int MMCompactHitRef::GetNHits() const {
+  return 1 + m_hit->m_Ndup;
+}
+
+inline MMCompactHitRef MMCompactHitRef::GetDuplicate(int idup) const {
+  return MMCompactHitRef(m_event->m_dups[m_hit->m_first_dup + idup], *m_event);
+}
+
+inline MMHit MMCompactHitRef::ToMMHit() const {
+  MMHit hit(MMFE8(), VMM(), VMMChannel(), RunNumber());
+  hit.SetPDO(PDO());
+  hit.SetTDO(TDO());
+  hit.SetBCID(BCID());
+  hit.SetTrigBCID(TrigBCID());
+  hit.SetTrigTDO(TrigTDO());
+  hit.SetFIFOcount(FIFOcount());
+  if(IsChargeCalib())
+    hit.SetCharge(Charge());
+  if(IsTimeCalib())
+    hit.SetTime(Time());
+  hit.SetPDOGain(PDOGain());
+  hit.SetPDOPed(PDOPed());
+  hit.SetTDOGain(TDOGain());
+  hit.SetTDOPed(TDOPed());
+  if(IsTrigCalib()){
+    hit.SetTrigTDOGain(TrigTDOGain());
+    hit.SetTrigTDOPed(TrigTDOPed());
+  }
+  return hit;
+}
+
+inline MMCompactEventHits::MMCompactEventHits(MMHitCalibTable* calib){
+  m_calib = calib;
+  m_RunNumber = -1;
+}
+
+inline void MMCompactEventHits::Append(vector<MMCompactHit>& hits, const MMHit& hit){
+  hits.push_back(MMCompactHit(hit, m_calib->Index(hit)));
+}
+
+inline void MMCompactEventHits::Fill(const MMEventHits& evt_hits){
+  m_hits.clear();
+  m_dups.clear();
+  m_board_first.clear();
+  m_RunNumber = -1;
+
+  int Nboard = evt_hits.GetNBoards();
+  for(int b = 0; b < Nboard; b++){
+    m_board_first.push_back(m_hits.size());
+    const MMFE8Hits& hits = evt_hits[b];
+    int Nhit = hits.GetNHits();
+    for(int i = 0; i < Nhit; i++){
+      const MMLinkedHit& hit = hits[i];
+      if(m_RunNumber < 0)
+        m_RunNumber = hit.RunNumber();
+      Append(m_hits, hit);
+
+      int Ndup = hit.GetNHits()-1;
+      if(Ndup == 0)
+        continue;
+      m_hits.back().m_first_dup = m_dups.size();
+      m_hits.back().m_Ndup = std::min(Ndup, 255);
+      const MMLinkedHit* dup = hit.GetNext();
+      for(int d = 0; d < m_hits.back().m_Ndup; d++){
+        Append(m_dups, *dup);
+        dup = dup->GetNext();
+      }
+    }
+  }
+  m_board_first.push_back(m_hits.size());
+}
+
+inline int MMCompactEventHits::GetNBoards() const {
+  return m_board_first.empty() ? 0 : int(m_board_first.size())-1;
+}
+
+inline int MMCompactEventHits::MMFE8(int iboard) const {
+  if(GetNHits(iboard) == 0)
+    return -1;
+  return m_hits[m_board_first[iboard]].m_MMFE8;
+}
+
+inline int MMCompactEventHits::GetNHits(int iboard) const {
+  return m_board_first[iboard+1] - m_board_first[iboard];
+}
+
+inline int MMCompactEventHits::GetNHits() const {
+  return int(m_hits.size());
+}
+
+inline int MMCompactEventHits::RunNumber() const {
+  return m_RunNumber;
+}
+
+inline MMCompactHitRef MMCompactEventHits::Get(int iboard, int ihit) const {
+  return MMCompactHitRef(m_hits[m_board_first[iboard] + ihit], *this);
+}
+
+inline const MMHitCalibTable& MMCompactEventHits::CalibTable() const {
+  return *m_calib;
+}
+
+inline size_t MMCompactEventHits::GetNBytes() const {
+  return sizeof(MMCompactEventHits) +
+    (m_hits.size() + m_dups.size())*sizeof(MMCompactHit) +
+    m_board_first.size()*sizeof(int);
+}
+
+inline size_t MMCompactEventHits::GetNBytes(const MMEventHits& evt_hits){
+  // MMEventHits object, trigger time table included
+  size_t N = sizeof(MMEventHits);
+  int Nboard = evt_hits.GetNBoards();
+  for(int b = 0; b < Nboard; b++){
+    const MMFE8Hits& hits = evt_hits[b];
+    int Nhit = hits.GetNHits();
+    N += sizeof(MMFE8Hits*) + sizeof(MMFE8Hits) + Nhit*sizeof(MMLinkedHit*);
+    for(int i = 0; i < Nhit; i++)
+      N += hits[i].GetNHits()*sizeof(MMLinkedHit);
+  }
+  return N;
+}
+
+#endif
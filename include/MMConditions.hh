@@ -0,0 +1,342 @@
+///
+///  \file   MMConditions.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMConditions_HH
+#define MMConditions_HH
+
+#include <climits>
+#include <cmath>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "include/MMRunSettings.hh"
+#include "include/MMBoardMap.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMConditions class
+//
+// Run-keyed constants, one per line:
+//
+//   <first run> <last run|*> <key> <values>
+//
+//   readout         nonl0|l0       BCID decoding (MMReadoutMode.hh)
+//   offset          <mm>           board 0 - 1 alignment
+//   offset_slope    <mm/mm>        its change with x_bary of board 1
+//   skip_transition <0|1>
+//   bcid_diff       <min> <max>|off
+//   trig_bcid       <min> <max>|off
+//   trig_bcid_rel   <min> <max>|off
+//   boards          <id> <id> ...  MMFE8 ids by boardId (layer)
+//   tp_boards       <id> <id> ...  trigger processor ids by layer
+//   plane_z         <mm> ...       plane z by layer
+//   plane_stereo    <deg> ...      stereo angle by layer, 0: X plane
+//
+// Later lines override earlier ones. The
+// built-in table holds the test beam values
+// and a file given with Load() extends it.
+// Resolve(run) turns the lines valid for a
+// run into MMRunSettings and flat board-id
+// tables; the result is kept for the whole
+// interval of runs over which it is valid
+///////////////////////////////////////////////
+
+class MMConditions {
+
+public:
+  MMConditions();
+  ~MMConditions() {}
+
+  // process-wide instance (used by TPHit)
+  static MMConditions& Get();
+
+  bool Load(const string& filename);
+  bool LoadText(const string& text, const string& source);
+
+  // makes run current: settings, board tables and the
+  // MMBoardMap; no-op while run is in the cached interval
+  bool Resolve(int run);
+
+  const MMRunSettings& Settings() const;
+  int FirstValidRun() const;
+  int LastValidRun() const;
+
+  // O(1) board id -> layer index for the current run, -1 if unmapped
+  int BoardIndex(int mmfe8) const;
+  int TPBoardIndex(int mmfe8) const;
+
+  // resolves run first if needed (TPHit::SetMMFE8Index);
+  // runs without tp_boards fall back to the MMFE8 board map
+  int TPBoardIndex(int run, int mmfe8);
+
+private:
+  struct Entry {
+    int first;
+    int last;
+    string key;
+    vector<string> values;
+    string where;
+  };
+  vector<Entry> m_entries;
+
+  bool m_resolved;
+  int m_run;
+  int m_first_valid;
+  int m_last_valid;
+  MMRunSettings m_settings;
+  int m_board_index[MMBoardMap::MAXID];
+  int m_tp_board_index[MMBoardMap::MAXID];
+  bool m_has_tp_boards;
+
+  void Apply(const Entry& entry);
+  bool ParseWindow(const Entry& entry, bool& use, int& min, int& max) const;
+  void SetBoards(const Entry& entry, int* table);
+};
+
+// values formerly hardcoded in RunTBAnalysis.C, MMHit and TPHit
+static const char* MMConditions_default =
+  "0    *    readout         nonl0\n"
+  "0    *    offset          -1.2\n"
+  "0    *    skip_transition 1\n"
+  "0    *    bcid_diff       -2 7\n"
+  "0    *    trig_bcid       off\n"
+  "0    *    trig_bcid_rel   off\n"
+  "0    *    boards          2 3\n"
+  "0    *    plane_z         0 11.2 32.4 43.6 113.6 124.8 146.0 157.2\n"
+  "0    *    plane_stereo    0 0 1.5 -1.5 1.5 -1.5 0 0\n"
+  "324  324  offset          -0.54\n"
+  "525  525  offset          -3.7\n"
+  "525  525  skip_transition 0\n"
+  "525  525  bcid_diff       off\n"
+  "525  525  trig_bcid       -172 -172\n"
+  "525  525  trig_bcid_rel   -173 -172\n"
+  "453  453  offset          -1.7\n"
+  "453  453  skip_transition 0\n"
+  "453  453  bcid_diff       off\n"
+  "453  453  trig_bcid       45 45\n"
+  "453  453  trig_bcid_rel   44 45\n"
+  "3513 3513 tp_boards       111 116 101 109 117 102 107 105\n"
+  "3516 3516 tp_boards       111 116 117 119 106 107 118 105\n"
+  "3518 3523 tp_boards       118 116 102 119 106 107 117 105\n"
+  "3524 3524 tp_boards       118 116 102 119 106 107 101 105\n"
+  "3525 3539 tp_boards       118 111 120 119 106 107 101 105\n"
+  "3540 *    tp_boards       119 124 122 126 106 109 125 123\n";
+
+inline MMConditions::MMConditions(){
+  m_resolved = false;
+  m_run = -1;
+  m_first_valid = 0;
+  m_last_valid = -1;
+  m_has_tp_boards = false;
+  LoadText(MMConditions_default, "built-in");
+}
+
+inline MMConditions& MMConditions::Get(){
+  static MMConditions conditions;
+  return conditions;
+}
+
+inline bool MMConditions::Load(const string& filename){
+  ifstream file(filename.c_str());
+  if(!file.is_open()){
+    cout << "MMConditions ERROR: cannot open conditions file " << filename << endl;
+    return false;
+  }
+  stringstream text;
+  text << file.rdbuf();
+  return LoadText(text.str(), filename);
+}
+
+inline bool MMConditions::LoadText(const string& text, const string& source){
+  istringstream lines(text);
+  string line;
+  int iline = 0;
+  bool ok = true;
+  while(getline(lines, line)){
+    iline++;
+    size_t comment = line.find('#');
+    if(comment != string::npos)
+      line.erase(comment);
+
+    istringstream fields(line);
+    string first, last;
+    Entry entry;
+    if(!(fields >> first))
+      continue;
+    if(!(fields >> last >> entry.key)){
+      cout << "MMConditions ERROR: " << source << ":" << iline << ": expected <first> <last> <key> <values>" << endl;
+      ok = false;
+      continue;
+    }
+    entry.first = atoi(first.c_str());
+    entry.last  = (last == "*") ? INT_MAX : atoi(last.c_str());
+    string value;
+    while(fields >> value)
+      entry.values.push_back(value);
+    entry.where = source + ":" + to_string(iline);
+    m_entries.push_back(entry);
+  }
+
+  // new lines may change the current run
+  m_resolved = false;
+  return ok;
+}
+
+inline bool MMConditions::ParseWindow(const Entry& entry, bool& use, int& min, int& max) const {
+  if(entry.values.size() == 1 && entry.values[0] == "off"){
+    use = false;
+    return true;
+  }
+  if(entry.values.size() == 2){
+    use = true;
+    min = atoi(entry.values[0].c_str());
+    max = atoi(entry.values[1].c_str());
+    return true;
+  }
+  cout << "MMConditions ERROR: " << entry.where << ": " << entry.key << " expects <min> <max> or off" << endl;
+  return false;
+}
+
+inline void MMConditions::SetBoards(const Entry& entry, int* table){
+  for(int i = 0; i < MMBoardMap::MAXID; i++)
+    table[i] = -1;
+  int Nboard = entry.values.size();
+  for(int l = 0; l < Nboard && l < MMBoardMap::NBOARD; l++){
+    int id = atoi(entry.values[l].c_str());
+    if(id >= 0 && id < MMBoardMap::MAXID)
+      table[id] = l;
+    else
+      cout << "MMConditions ERROR: " << entry.where << ": board id " << id << " out of range" << endl;
+  }
+}
+
+inline void MMConditions::Apply(const Entry& entry){
+  bool use;
+  int min = 0, max = 0;
+  if(entry.key == "readout" && entry.values.size() == 1 && ParseReadout(entry.values[0]) >= 0){
+    m_settings.SetReadout(ParseReadout(entry.values[0]));
+  } else if(entry.key == "offset" && entry.values.size() == 1){
+    m_settings.SetOffset(atof(entry.values[0].c_str()));
+  } else if(entry.key == "offset_slope" && entry.values.size() == 1){
+    m_settings.SetOffsetSlope(atof(entry.values[0].c_str()));
+  } else if(entry.key == "skip_transition" && entry.values.size() == 1){
+    m_settings.SetSkipTransition(atoi(entry.values[0].c_str()) != 0);
+  } else if(entry.key == "bcid_diff"){
+    if(ParseWindow(entry, use, min, max)){
+      if(use)
+        m_settings.SetBCIDDiff(min, max);
+      m_settings.SetUseBCIDDiff(use);
+    }
+  } else if(entry.key == "trig_bcid"){
+    if(ParseWindow(entry, use, min, max)){
+      if(use)
+        m_settings.SetTrigBCIDWindow(min, max);
+      m_settings.SetUseTrigBCIDWindow(use);
+    }
+  } else if(entry.key == "trig_bcid_rel"){
+    if(ParseWindow(entry, use, min, max)){
+      if(use)
+        m_settings.SetTrigBCIDrelWindow(min, max);
+      m_settings.SetUseTrigBCIDrelWindow(use);
+    }
+  } else if(entry.key == "boards"){
+    SetBoards(entry, m_board_index);
+  } else if(entry.key == "tp_boards"){
+    SetBoards(entry, m_tp_board_index);
+    m_has_tp_boards = true;
+  } else if(entry.key == "plane_z" && entry.values.size() <= MMBoardMap::NBOARD){
+    for(int l = 0; l < int(entry.values.size()); l++)
+      m_settings.SetPlaneZ(l, atof(entry.values[l].c_str()));
+  } else if(entry.key == "plane_stereo" && entry.values.size() <= MMBoardMap::NBOARD){
+    for(int l = 0; l < int(entry.values.size()); l++)
+      m_settings.SetPlaneStereo(l, atof(entry.values[l].c_str())*M_PI/180.);
+  } else {
+    cout << "MMConditions ERROR: " << entry.where << ": unknown key or wrong number of values for "
+         << entry.key << endl;
+  }
+}
+
+inline bool MMConditions::Resolve(int run){
+  // same lines apply: only the run number changes
+  if(m_resolved && run >= m_first_valid && run <= m_last_valid){
+    m_settings.SetRunNumber(run);
+    m_run = run;
+    return true;
+  }
+
+  m_settings = MMRunSettings(run);
+  for(int i = 0; i < MMBoardMap::MAXID; i++){
+    m_board_index[i] = -1;
+    m_tp_board_index[i] = -1;
+  }
+  m_has_tp_boards = false;
+
+  // interval over which the same set of lines applies
+  m_first_valid = INT_MIN;
+  m_last_valid  = INT_MAX;
+  for(auto& entry: m_entries){
+    if(run >= entry.first && run <= entry.last){
+      Apply(entry);
+      m_first_valid = std::max(m_first_valid, entry.first);
+      m_last_valid  = std::min(m_last_valid,  entry.last);
+    } else if(entry.last < run){
+      m_first_valid = std::max(m_first_valid, entry.last+1);
+    } else {
+      m_last_valid  = std::min(m_last_valid,  entry.first-1);
+    }
+  }
+
+  MMBoardMap::Clear();
+  for(int id = 0; id < MMBoardMap::MAXID; id++)
+    if(m_board_index[id] >= 0)
+      MMBoardMap::SetIndex(id, m_board_index[id]);
+
+  m_run = run;
+  m_resolved = true;
+  return true;
+}
+
+inline const MMRunSettings& MMConditions::Settings() const {
+  return m_settings;
+}
+
+inline int MMConditions::FirstValidRun() const {
+  return m_first_valid;
+}
+
+inline int MMConditions::LastValidRun() const {
+  return m_last_valid;
+}
+
+inline int MMConditions::BoardIndex(int mmfe8) const {
+  if(mmfe8 < 0 || mmfe8 >= MMBoardMap::MAXID)
+    return -1;
+  return m_board_index[mmfe8];
+}
+
+inline int MMConditions::TPBoardIndex(int mmfe8) const {
+  if(mmfe8 < 0 || mmfe8 >= MMBoardMap::MAXID)
+    return -1;
+  return m_tp_board_index[mmfe8];
+}
+
+inline int MMConditions::TPBoardIndex(int run, int mmfe8){
+  if(!m_resolved || run < m_first_valid || run > m_last_valid)
+    Resolve(run);
+  // primitives from the MMFE8s themselves (ART) use the board map
+  if(!m_has_tp_boards)
+    return BoardIndex(mmfe8);
+  return TPBoardIndex(mmfe8);
+}
+
+#endif
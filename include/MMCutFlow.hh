@@ -0,0 +1,270 @@
+///
+///  \file   MMCutFlow.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMCutFlow_HH
+#define MMCutFlow_HH
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <algorithm>
+#include <cmath>
+
+#include <TDirectory.h>
+#include <TH1D.h>
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMCutFlow class
+//
+// Event selection as named cuts with their
+// accounting: events tested, events passed and
+// the wall time of the test, per cut. The time
+// is sampled on one test in kTimeEvery, as the
+// clock reads cost more than most cuts.
+// Apply(k, test) runs test(k) for one cut;
+// ApplyGroup() runs a group of independent
+// cuts (their AND does not depend on the
+// order) and stops at the first failure. In
+// adaptive mode the group is re-sorted every N
+// calls by cost / rejection (ns per test over
+// the fraction rejected), which minimises the
+// expected time for uncorrelated cuts: cheap
+// cuts with high rejection run first. Costs
+// are counted in steps of the timer
+// resolution, so cuts within one step of each
+// other are ordered by rejection alone.
+// Write() stores the counts as histograms,
+// summed by the merger
+///////////////////////////////////////////////
+
+class MMCutFlow {
+
+public:
+  MMCutFlow(bool adaptive = false, int reorder_every = 1000);
+  // one timed test per cut in kTimeEvery
+  static const int kTimeEvery = 64;
+  ~MMCutFlow() {}
+
+  // in the nominal order
+  int AddCut(const string& name);
+  int AddGroup(const vector<int>& cuts);
+
+  // one call per event entering the selection
+  void CountEvent();
+
+  // test(cut) -> true if the event passes
+  template <class TEST> bool Apply(int cut, TEST test);
+  template <class TEST> bool ApplyGroup(int group, TEST test);
+
+  int GetNCuts() const;
+  Long64_t GetNTested(int cut) const;
+  Long64_t GetNPassed(int cut) const;
+  double GetRejection(int cut) const;
+  double GetCost(int cut) const;        // ns per test
+  double GetResolution() const;         // ns, smallest clock step
+  const vector<int>& GetOrder(int group) const;
+
+  void Print(const string& prefix = "") const;
+  // cutflow_tested, cutflow_passed, cutflow_ns
+  void Write(TDirectory* dir) const;
+
+private:
+  struct Cut {
+    string name;
+    Long64_t tested;
+    Long64_t passed;
+    Long64_t timed;
+    double ns;      // of the timed tests
+  };
+  struct Group {
+    vector<int> order;
+    Long64_t calls;
+  };
+
+  bool m_adaptive;
+  int m_every;
+  Long64_t m_Nevent;
+  double m_resolution;
+  vector<Cut> m_cuts;
+  vector<Group> m_groups;
+
+  double Rank(int cut) const;
+  void Reorder(Group& group);
+};
+
+inline MMCutFlow::MMCutFlow(bool adaptive, int reorder_every){
+  m_adaptive = adaptive;
+  m_every = std::max(1, reorder_every);
+  m_Nevent = 0;
+
+  // smallest step seen between two clock reads, the
+  // read itself included: cost differences below it are noise
+  m_resolution = 1e300;
+  for(int i = 0; i < 100; i++){
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    chrono::steady_clock::time_point t1 = chrono::steady_clock::now();
+    while(t1 == t0)
+      t1 = chrono::steady_clock::now();
+    m_resolution = std::min(m_resolution, chrono::duration<double, nano>(t1 - t0).count());
+  }
+}
+
+inline int MMCutFlow::AddCut(const string& name){
+  Cut cut;
+  cut.name = name;
+  cut.tested = 0;
+  cut.passed = 0;
+  cut.timed = 0;
+  cut.ns = 0.;
+  m_cuts.push_back(cut);
+  return m_cuts.size() - 1;
+}
+
+inline int MMCutFlow::AddGroup(const vector<int>& cuts){
+  Group group;
+  group.order = cuts;
+  group.calls = 0;
+  m_groups.push_back(group);
+  return m_groups.size() - 1;
+}
+
+inline void MMCutFlow::CountEvent(){
+  m_Nevent++;
+}
+
+template <class TEST>
+inline bool MMCutFlow::Apply(int k, TEST test){
+  Cut& cut = m_cuts[k];
+  bool pass;
+  if(cut.tested % kTimeEvery == 0){
+    chrono::steady_clock::time_point t0 = chrono::steady_clock::now();
+    pass = test(k);
+    cut.ns += chrono::duration<double, nano>(chrono::steady_clock::now() - t0).count();
+    cut.timed++;
+  } else {
+    pass = test(k);
+  }
+  cut.tested++;
+  cut.passed += pass;
+  return pass;
+}
+
+template <class TEST>
+inline bool MMCutFlow::ApplyGroup(int g, TEST test){
+  Group& group = m_groups[g];
+  bool pass = true;
+  for(int k: group.order)
+    if(!Apply(k, test)){
+      pass = false;
+      break;
+    }
+  if(m_adaptive && ++group.calls % m_every == 0)
+    Reorder(group);
+  return pass;
+}
+
+inline double MMCutFlow::Rank(int k) const {
+  const Cut& cut = m_cuts[k];
+  // not tested yet (behind a cut rejecting everything): keep it last
+  if(cut.tested == 0)
+    return 1e300;
+  double rejection = 1. - double(cut.passed)/double(cut.tested);
+  // cost in whole resolution steps, at least one
+  double steps = std::max(1., std::ceil(GetCost(k)/m_resolution));
+  return steps / std::max(rejection, 1e-9);
+}
+
+inline void MMCutFlow::Reorder(Group& group){
+  std::stable_sort(group.order.begin(), group.order.end(),
+                   [this](int a, int b){ return Rank(a) < Rank(b); });
+}
+
+inline int MMCutFlow::GetNCuts() const {
+  return m_cuts.size();
+}
+
+inline Long64_t MMCutFlow::GetNTested(int k) const {
+  return m_cuts[k].tested;
+}
+
+inline Long64_t MMCutFlow::GetNPassed(int k) const {
+  return m_cuts[k].passed;
+}
+
+inline double MMCutFlow::GetRejection(int k) const {
+  if(m_cuts[k].tested == 0)
+    return 0.;
+  return 1. - double(m_cuts[k].passed)/double(m_cuts[k].tested);
+}
+
+inline double MMCutFlow::GetCost(int k) const {
+  if(m_cuts[k].timed == 0)
+    return 0.;
+  return m_cuts[k].ns/m_cuts[k].timed;
+}
+
+inline double MMCutFlow::GetResolution() const {
+  return m_resolution;
+}
+
+inline const vector<int>& MMCutFlow::GetOrder(int g) const {
+  return m_groups[g].order;
+}
+
+inline void MMCutFlow::Print(const string& prefix) const {
+  cout << prefix << "cut flow, " << m_Nevent << " events" << (m_adaptive ? " (adaptive order)" : "")
+       << ", 1 test in " << kTimeEvery << " timed, clock step " << m_resolution << " ns" << endl;
+  cout << "  " << setw(22) << left << "cut" << right << setw(12) << "tested" << setw(12) << "passed"
+       << setw(12) << "rejected" << setw(10) << "ns/test" << endl;
+  for(int k = 0; k < GetNCuts(); k++)
+    cout << "  " << setw(22) << left << m_cuts[k].name << right
+         << setw(12) << m_cuts[k].tested << setw(12) << m_cuts[k].passed
+         << fixed << setprecision(1) << setw(11) << 100.*GetRejection(k) << "%"
+         << setw(10) << GetCost(k) << defaultfloat << setprecision(6) << endl;
+  if(!m_adaptive)
+    return;
+  for(const Group& group: m_groups){
+    cout << "  final order:";
+    for(int k: group.order)
+      cout << " " << m_cuts[k].name;
+    cout << endl;
+  }
+}
+
+inline void MMCutFlow::Write(TDirectory* dir) const {
+  int N = GetNCuts();
+  TH1D* tested = new TH1D("cutflow_tested", ";cut;Events tested", N+1, -0.5, N+0.5);
+  TH1D* passed = new TH1D("cutflow_passed", ";cut;Events passed", N+1, -0.5, N+0.5);
+  TH1D* ns     = new TH1D("cutflow_ns",     ";cut;Test time [ns]", N+1, -0.5, N+0.5);
+  // bin 1: events entering the selection
+  tested->SetBinContent(1, m_Nevent);
+  passed->SetBinContent(1, m_Nevent);
+  for(TH1D* hist: {tested, passed, ns})
+    hist->GetXaxis()->SetBinLabel(1, "events");
+  for(int k = 0; k < N; k++){
+    tested->SetBinContent(k+2, m_cuts[k].tested);
+    passed->SetBinContent(k+2, m_cuts[k].passed);
+    // estimated total over all tests, from the timed ones
+    ns->SetBinContent(k+2, GetCost(k)*m_cuts[k].tested);
+    for(TH1D* hist: {tested, passed, ns})
+      hist->GetXaxis()->SetBinLabel(k+2, m_cuts[k].name.c_str());
+  }
+  dir->cd();
+  for(TH1D* hist: {tested, passed, ns}){
+    hist->SetDirectory(0);
+    hist->Write();
+    delete hist;
+  }
+}
+
+#endif
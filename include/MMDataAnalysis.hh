@@ -14,6 +14,9 @@
 #include "include/MMDataBaseTestBeam.hh"
 //#include "include/MMRunProperties.hh"
 #include "include/MMEventHits.hh"
+#include "include/MMChannelMask.hh"
+#include "include/MMReadoutMode.hh"
+#include "include/MMBoardMap.hh"
 
 class MMDataAnalysis : public MMDataBaseTestBeam {
 
@@ -25,15 +28,42 @@ public:
   virtual Int_t GetEntry(Long64_t entry);
   virtual Int_t GetTP();
   virtual void  SetTP(Int_t doTP);
+  int RunNumber() const;
+
+  // kReadoutNonL0 (default) or kReadoutL0, see MMReadoutMode.hh
+  void SetReadout(int readout);
+  int  GetReadout() const;
+
+  // occupancy pre-pass over Nsample entries from first: masks
+  // the hot and dead channels (see MMChannelMask), returns how many
+  int FindNoisyChannels(Long64_t first, Long64_t Nsample,
+                        double hot_factor = 10., double dead_factor = 0.05);
+
+  // (MMFE8, trigger counter) of each board read out in entry,
+  // from the counter branches only (see MMEventBuilder)
+  int GetBoardCounters(Long64_t entry, std::vector<int>& boards, std::vector<int>& counters);
   //  virtual void  LoadRunProperties(TTree *rtree=0);
 
   MMEventHits mm_EventHits;
+  // ART trigger primitives of the event (one per valid VMM readout)
+  std::vector<TPHit> mm_ARTHits;
+  // channels skipped at decode
+  MMChannelMask mm_ChannelMask;
   //  MMRunProperties mm_RunProperties;
 
 private:
   int m_Nentry;
   int m_doTP;
   int m_RunNum = -1;
+  int m_readout;
+  mutable long m_Nunmapped;
+
+  // MMFE8 id of chip readout i, -1 if its board is not mapped
+  int BoardIP(int i) const;
+
+  // builds the event of the entry just read
+  template <class MODE>
+  void Decode();
 };
 
 #endif
@@ -47,6 +77,9 @@ inline MMDataAnalysis::MMDataAnalysis(TTree *tree, int runnum)
     m_Nentry = 0;
   m_doTP = 1;
   m_RunNum = runnum;
+  m_readout = kReadoutNonL0;
+  m_Nunmapped = 0;
+  mm_ChannelMask.SetDefault();
 }
   
 inline MMDataAnalysis::~MMDataAnalysis() {}
@@ -55,6 +88,10 @@ inline Int_t MMDataAnalysis::GetNEntries(){
   return m_Nentry;
 }
 
+inline int MMDataAnalysis::RunNumber() const {
+  return m_RunNum;
+}
+
 inline Int_t MMDataAnalysis::GetTP(){
   return m_doTP;
 }
@@ -63,6 +100,71 @@ inline void MMDataAnalysis::SetTP(int doTP){
   m_doTP = doTP;
 }
 
+inline void MMDataAnalysis::SetReadout(int readout){
+  m_readout = readout;
+}
+
+inline int MMDataAnalysis::GetReadout() const {
+  return m_readout;
+}
+
+// boardId is the layer of the board in the readout; its
+// MMFE8 id comes from the conditions boards table of the
+// run (MMBoardMap), e.g. boards 2 3: boardId 0 -> 2, 1 -> 3
+inline int MMDataAnalysis::BoardIP(int i) const {
+  int mmfe8 = MMBoardMap::MMFE8(boardId->at(i));
+  if(mmfe8 < 0 && m_Nunmapped++ == 0)
+    std::cout << "MMDataAnalysis WARNING: run " << m_RunNum << ": boardId " << boardId->at(i)
+              << " has no board in the conditions boards table, its hits are skipped" << std::endl;
+  return mmfe8;
+}
+
+inline int MMDataAnalysis::FindNoisyChannels(Long64_t first, Long64_t Nsample,
+                                             double hot_factor, double dead_factor){
+  mm_ChannelMask.ResetCounts();
+  Long64_t last = std::min(Long64_t(m_Nentry), first + Nsample);
+  for(Long64_t entry = first; entry < last; entry++){
+    // only the branches needed to count hits
+    Long64_t centry = LoadTree(entry);
+    if(centry < 0)
+      break;
+    b_boardId->GetEntry(centry);
+    b_chip->GetEntry(centry);
+    b_channel->GetEntry(centry);
+    for(int i = 0; i < chip->size(); i++){
+      int boardIP = BoardIP(i);
+      if(boardIP < 0)
+        continue;
+      for(int j = 0; j < channel->at(i).size(); j++)
+        mm_ChannelMask.Count(boardIP, chip->at(i), channel->at(i).at(j));
+    }
+    mm_ChannelMask.CountEvent();
+  }
+  return mm_ChannelMask.Flag(hot_factor, dead_factor);
+}
+
+inline int MMDataAnalysis::GetBoardCounters(Long64_t entry, std::vector<int>& boards,
+                                            std::vector<int>& counters){
+  boards.clear();
+  counters.clear();
+  Long64_t centry = LoadTree(entry);
+  if(centry < 0)
+    return 0;
+  b_boardId->GetEntry(centry);
+  b_chip->GetEntry(centry);
+  b_triggerCounter->GetEntry(centry);
+  bool has_counter = triggerCounter && triggerCounter->size() == chip->size();
+  // first chip readout of each board
+  for(int i = 0; i < chip->size(); i++){
+    int boardIP = BoardIP(i);
+    if(boardIP < 0 || std::find(boards.begin(), boards.end(), boardIP) != boards.end())
+      continue;
+    boards.push_back(boardIP);
+    counters.push_back(has_counter ? triggerCounter->at(i) : -1);
+  }
+  return boards.size();
+}
+
 inline Int_t MMDataAnalysis::GetEntry(Long64_t entry){
 
   if(entry < 0 || entry >= m_Nentry)
@@ -71,8 +173,21 @@ inline Int_t MMDataAnalysis::GetEntry(Long64_t entry){
 
   int ret = MMDataBaseTestBeam::GetEntry(entry);
 
+  // one mode dispatch per event
+  if(m_readout == kReadoutL0)
+    Decode<MMReadoutL0>();
+  else
+    Decode<MMReadoutNonL0>();
+
+  return ret;
+}
+
+template <class MODE>
+inline void MMDataAnalysis::Decode(){
+
   // clear previous event micromega hits;
-  mm_EventHits = MMEventHits();
+  mm_EventHits.Clear();
+  mm_ARTHits.clear();
   mm_EventHits.SetTime(-1.,-1.);
   //mm_EventHits.SetTime(mm_Time_sec,mm_Time_nsec);
   mm_EventHits.SetEventNum(*triggerCounter);
@@ -83,28 +198,24 @@ inline Int_t MMDataAnalysis::GetEntry(Long64_t entry){
   int trig_TDO = -1;
 
   for(int i = 0; i < chip->size(); i++){
+    boardIP = BoardIP(i);
+    if (boardIP < 0)
+      continue;
     for(int j = 0; j < channel->at(i).size(); j++){
       if (channel->at(i).at(j) != 63)
         continue;
-      if (boardId->at(i) == 0)
-        boardIP = 2;
-      else {
-        boardIP = 3;
-      }
-      mm_EventHits.SetTrigTime(grayDecoded->at(i).at(j), tdo->at(i).at(j), boardIP, chip->at(i)); // uncomment for non-L0
-      //mm_EventHits.SetTrigTime(bcid->at(i).at(j)+relbcid->at(i).at(j), tdo->at(i).at(j), boardIP, chip->at(i));
+      mm_EventHits.SetTrigTime(MODE::BCID(*this, i, j), tdo->at(i).at(j), boardIP, chip->at(i));
       mm_EventHits.SetTrigL0BCID(bcid->at(i).at(j), boardIP, chip->at(i));
     }
   }
 
   for(int i = 0; i < chip->size(); i++){
+    boardIP = BoardIP(i);
+    if (boardIP < 0)
+      continue;
     for(int j = 0; j < channel->at(i).size(); j++){
-      if (boardId->at(i) == 0)
-        boardIP = 2;
-      else {
-        boardIP = 3;
-      }
-      if (boardIP == 3 && channel->at(i).at(j) > 60 && channel->at(i).at(j) < 63)
+      // masked hits are never built
+      if (mm_ChannelMask.IsMasked(boardIP, chip->at(i), channel->at(i).at(j)))
         continue;
       MMHit hit(boardIP,
                 chip->at(i),
@@ -112,8 +223,7 @@ inline Int_t MMDataAnalysis::GetEntry(Long64_t entry){
                 m_RunNum);
       hit.SetPDO(pdo->at(i).at(j));
       hit.SetTDO(tdo->at(i).at(j));
-      //hit.SetBCID(bcid->at(i).at(j)+relbcid->at(i).at(j)); // L0 only
-      hit.SetBCID(grayDecoded->at(i).at(j)); // uncomment for non L0
+      hit.SetBCID(MODE::BCID(*this, i, j));
       hit.SetTrigBCID(mm_EventHits.TrigTimeBCID(boardIP, chip->at(i)));
       hit.SetTrigTDO(mm_EventHits.TrigTimeTDO(boardIP, chip->at(i)));
 
@@ -122,7 +232,18 @@ inline Int_t MMDataAnalysis::GetEntry(Long64_t entry){
     }
   }
 
-  return ret;
+  // ART address of each VMM readout (art branches are per chip entry)
+  if (m_doTP && art && art_valid && art->size() == chip->size()){
+    for(int i = 0; i < chip->size(); i++){
+      if (!art_valid->at(i))
+        continue;
+      boardIP = BoardIP(i);
+      if (boardIP < 0)
+        continue;
+      int art_bcid = (art_trigger && art_trigger->size() == chip->size()) ? art_trigger->at(i) : -1;
+      mm_ARTHits.push_back(TPHit(boardIP, chip->at(i), art->at(i), art_bcid, m_RunNum));
+    }
+  }
 }
 
 // inline void MMDataAnalysis::LoadRunProperties(TTree *rtree){
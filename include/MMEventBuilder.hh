@@ -0,0 +1,361 @@
+///
+///  \file   MMEventBuilder.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMEventBuilder_HH
+#define MMEventBuilder_HH
+
+#include <iostream>
+#include <vector>
+#include <map>
+#include <queue>
+#include <algorithm>
+
+#include "include/MMEventHits.hh"
+#include "include/MMChannelMask.hh"
+#include "include/MMBoardMap.hh"
+#include "include/TPHit.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMEventBuilder class
+//
+// Builds events from per-board streams
+// instead of tree entries. Each board's
+// readouts (MMFE8, trigger counter, entry)
+// form one stream in entry order; Index()
+// reads the counters of the whole run
+// (counter branches only), sorts each stream
+// within a bounded reorder window of W
+// fragments, then merges the k streams with a
+// heap on the trigger counter: the fragments
+// with equal counters make one event, with
+// one fragment per board (a repeated
+// (board, counter) is counted and dropped).
+//
+// GetEntry(i) then decodes the entries of
+// event i through the reader (a few cached)
+// and assembles the hits, trigger times and
+// ART hits of each board from its own entry.
+// Same interface as the readers, so it can
+// stand in for one in the analysis
+///////////////////////////////////////////////
+
+template <class DATA_T>
+class MMEventBuilder {
+
+public:
+  MMEventBuilder(DATA_T* DATA, int window = 8);
+  ~MMEventBuilder();
+
+  // counter pass over all entries, returns the number of events
+  Long64_t Index();
+
+  int RunNumber() const;
+  Int_t GetNEntries();
+  Int_t GetEntry(Long64_t event);
+  Int_t GetTP();
+  void  SetTP(Int_t doTP);
+  void SetReadout(int readout);
+  int  GetReadout() const;
+  int FindNoisyChannels(Long64_t first, Long64_t Nsample,
+                        double hot_factor = 10., double dead_factor = 0.05);
+
+  // trigger counter and number of boards of an event
+  int TriggerCounter(Long64_t event) const;
+  int GetNBoards(Long64_t event) const;
+
+  Long64_t GetNComplete() const;
+  Long64_t GetNIncomplete() const;
+  // fragments still out of order after the reorder window
+  Long64_t GetNLate() const;
+  // fragments dropped as a repeat of (board, counter)
+  Long64_t GetNDuplicate() const;
+  void Print() const;
+
+  MMEventHits mm_EventHits;
+  std::vector<TPHit> mm_ARTHits;
+  MMChannelMask& mm_ChannelMask;
+
+private:
+  DATA_T* m_data;
+  int m_window;
+  int m_Nboard;
+
+  // event i: fragments [m_first[i], m_first[i+1])
+  vector<Long64_t> m_first;
+  vector<int> m_counter;
+  vector<int> m_frag_board;
+  vector<Long64_t> m_frag_entry;
+
+  Long64_t m_Ncomplete;
+  Long64_t m_Nincomplete;
+  Long64_t m_Nlate;
+  Long64_t m_Nduplicate;
+
+  // decoded entries, most recent last
+  struct CachedEntry {
+    Long64_t entry;
+    MMEventHits* hits;
+    vector<TPHit> art;
+  };
+  vector<CachedEntry> m_cache;
+  size_t m_cache_size;
+
+  const CachedEntry& Decode(Long64_t entry);
+  void ClearCache();
+};
+
+template <class DATA_T>
+inline MMEventBuilder<DATA_T>::MMEventBuilder(DATA_T* DATA, int window)
+  : mm_ChannelMask(DATA->mm_ChannelMask) {
+  m_data = DATA;
+  m_window = std::max(1, window);
+  m_Nboard = 0;
+  m_Ncomplete = 0;
+  m_Nincomplete = 0;
+  m_Nlate = 0;
+  m_Nduplicate = 0;
+  m_cache_size = m_window + 2;
+  m_first.push_back(0);
+}
+
+template <class DATA_T>
+inline MMEventBuilder<DATA_T>::~MMEventBuilder(){
+  ClearCache();
+}
+
+template <class DATA_T>
+inline Long64_t MMEventBuilder<DATA_T>::Index(){
+  m_first.assign(1, 0);
+  m_counter.clear();
+  m_frag_board.clear();
+  m_frag_entry.clear();
+  m_Ncomplete = 0;
+  m_Nincomplete = 0;
+  m_Nlate = 0;
+  m_Nduplicate = 0;
+  ClearCache();
+
+  // (counter, entry) fragments of each board, entry ordered;
+  // entries without counters are keyed on the entry number
+  typedef pair<int, Long64_t> Fragment;
+  map<int, vector<Fragment> > streams;
+  vector<int> boards, counters;
+  Long64_t Nentry = m_data->GetNEntries();
+  for(Long64_t entry = 0; entry < Nentry; entry++){
+    m_data->GetBoardCounters(entry, boards, counters);
+    for(int b = 0; b < int(boards.size()); b++)
+      streams[boards[b]].push_back(Fragment(counters[b] >= 0 ? counters[b] : int(entry), entry));
+  }
+  m_Nboard = streams.size();
+
+  // bounded reorder: a fragment is released once W later
+  // fragments of its board have been seen
+  vector<int> board_id;
+  vector<vector<Fragment> > sorted;
+  for(auto& stream: streams){
+    priority_queue<Fragment, vector<Fragment>, greater<Fragment> > window;
+    vector<Fragment> out;
+    out.reserve(stream.second.size());
+    for(const Fragment& frag: stream.second){
+      window.push(frag);
+      if(int(window.size()) > m_window){
+        out.push_back(window.top());
+        window.pop();
+      }
+    }
+    while(!window.empty()){
+      out.push_back(window.top());
+      window.pop();
+    }
+    for(size_t i = 1; i < out.size(); i++)
+      if(out[i].first < out[i-1].first)
+        m_Nlate++;
+    board_id.push_back(stream.first);
+    sorted.push_back(out);
+  }
+
+  // k-way merge on (counter, board)
+  typedef pair<Fragment, pair<int,size_t> > Head; // fragment, (stream, position)
+  priority_queue<Head, vector<Head>, greater<Head> > heads;
+  for(int s = 0; s < int(sorted.size()); s++)
+    if(!sorted[s].empty())
+      heads.push(Head(sorted[s][0], make_pair(s, size_t(0))));
+
+  vector<char> in_event(sorted.size(), 0);
+  while(!heads.empty()){
+    int counter = heads.top().first.first;
+    int Nboard_event = 0;
+    while(!heads.empty() && heads.top().first.first == counter){
+      Head head = heads.top();
+      heads.pop();
+      int s = head.second.first;
+      size_t pos = head.second.second;
+      // first fragment of the board only, a second one
+      // would add its hits to the event again
+      if(!in_event[s]){
+        in_event[s] = 1;
+        Nboard_event++;
+        m_frag_board.push_back(board_id[s]);
+        m_frag_entry.push_back(head.first.second);
+      } else {
+        m_Nduplicate++;
+      }
+      if(pos+1 < sorted[s].size())
+        heads.push(Head(sorted[s][pos+1], make_pair(s, pos+1)));
+    }
+    std::fill(in_event.begin(), in_event.end(), 0);
+    m_counter.push_back(counter);
+    m_first.push_back(m_frag_board.size());
+    if(Nboard_event == m_Nboard)
+      m_Ncomplete++;
+    else
+      m_Nincomplete++;
+  }
+
+  return m_counter.size();
+}
+
+template <class DATA_T>
+inline void MMEventBuilder<DATA_T>::ClearCache(){
+  for(CachedEntry& cached: m_cache)
+    delete cached.hits;
+  m_cache.clear();
+}
+
+template <class DATA_T>
+inline const typename MMEventBuilder<DATA_T>::CachedEntry& MMEventBuilder<DATA_T>::Decode(Long64_t entry){
+  for(const CachedEntry& cached: m_cache)
+    if(cached.entry == entry)
+      return cached;
+
+  if(m_cache.size() >= m_cache_size){
+    delete m_cache.front().hits;
+    m_cache.erase(m_cache.begin());
+  }
+  m_data->GetEntry(entry);
+  CachedEntry cached;
+  cached.entry = entry;
+  cached.hits = new MMEventHits(m_data->mm_EventHits);
+  cached.hits->CopyTrigTime(m_data->mm_EventHits);
+  cached.art = m_data->mm_ARTHits;
+  m_cache.push_back(cached);
+  return m_cache.back();
+}
+
+template <class DATA_T>
+inline Int_t MMEventBuilder<DATA_T>::GetEntry(Long64_t event){
+  if(event < 0 || event >= Long64_t(m_counter.size()))
+    return false;
+
+  mm_EventHits.Clear();
+  mm_ARTHits.clear();
+  mm_EventHits.SetTime(-1.,-1.);
+
+  vector<int> counters;
+  for(Long64_t f = m_first[event]; f < m_first[event+1]; f++){
+    int board = m_frag_board[f];
+    const CachedEntry& cached = Decode(m_frag_entry[f]);
+    const MMEventHits& hits = *cached.hits;
+    counters.push_back(m_counter[event]);
+
+    // trigger times of this board and its VMMs, as decoded
+    mm_EventHits.CopyTrigTime(hits, board);
+    for(int i = 0; i < hits.GetNBoards(); i++)
+      if(hits[i].MMFE8() == board)
+        mm_EventHits += hits[i];
+    for(const TPHit& art: cached.art)
+      if(art.MMFE8() == board)
+        mm_ARTHits.push_back(art);
+  }
+  mm_EventHits.SetEventNum(counters);
+
+  return m_first[event+1] - m_first[event];
+}
+
+template <class DATA_T>
+inline int MMEventBuilder<DATA_T>::RunNumber() const {
+  return m_data->RunNumber();
+}
+
+template <class DATA_T>
+inline Int_t MMEventBuilder<DATA_T>::GetNEntries(){
+  return int(m_counter.size());
+}
+
+template <class DATA_T>
+inline Int_t MMEventBuilder<DATA_T>::GetTP(){
+  return m_data->GetTP();
+}
+
+template <class DATA_T>
+inline void MMEventBuilder<DATA_T>::SetTP(int doTP){
+  m_data->SetTP(doTP);
+  ClearCache();
+}
+
+template <class DATA_T>
+inline void MMEventBuilder<DATA_T>::SetReadout(int readout){
+  m_data->SetReadout(readout);
+  ClearCache();
+}
+
+template <class DATA_T>
+inline int MMEventBuilder<DATA_T>::GetReadout() const {
+  return m_data->GetReadout();
+}
+
+template <class DATA_T>
+inline int MMEventBuilder<DATA_T>::FindNoisyChannels(Long64_t first, Long64_t Nsample,
+                                                     double hot_factor, double dead_factor){
+  ClearCache();
+  return m_data->FindNoisyChannels(first, Nsample, hot_factor, dead_factor);
+}
+
+template <class DATA_T>
+inline int MMEventBuilder<DATA_T>::TriggerCounter(Long64_t event) const {
+  return m_counter[event];
+}
+
+template <class DATA_T>
+inline int MMEventBuilder<DATA_T>::GetNBoards(Long64_t event) const {
+  return m_first[event+1] - m_first[event];
+}
+
+template <class DATA_T>
+inline Long64_t MMEventBuilder<DATA_T>::GetNComplete() const {
+  return m_Ncomplete;
+}
+
+template <class DATA_T>
+inline Long64_t MMEventBuilder<DATA_T>::GetNIncomplete() const {
+  return m_Nincomplete;
+}
+
+template <class DATA_T>
+inline Long64_t MMEventBuilder<DATA_T>::GetNLate() const {
+  return m_Nlate;
+}
+
+template <class DATA_T>
+inline Long64_t MMEventBuilder<DATA_T>::GetNDuplicate() const {
+  return m_Nduplicate;
+}
+
+template <class DATA_T>
+inline void MMEventBuilder<DATA_T>::Print() const {
+  cout << "MMEventBuilder: " << m_counter.size() << " events from " << m_data->GetNEntries()
+       << " entries of " << m_Nboard << " boards (reorder window " << m_window << "): "
+       << m_Ncomplete << " complete, " << m_Nincomplete << " incomplete, "
+       << m_Nlate << " fragments late beyond the window, "
+       << m_Nduplicate << " duplicate fragments dropped" << endl;
+}
+
+#endif
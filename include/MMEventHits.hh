@@ -23,6 +23,11 @@ public:
   
   ~MMEventHits();
 
+  MMEventHits& operator = (const MMEventHits& evt_hits);
+
+  // removes all hits and trigger times
+  void Clear();
+
   bool AddHit(const MMHit& hit);
   bool AddHits(const MMFE8Hits& hits);
   bool AddLinkedHit(const MMLinkedHit& hit);
@@ -42,14 +47,26 @@ public:
   void SetTime(int time, int time_ns);    
   double Time();
 
+  // trigger time of a board (MMFE8 board id): the last trigger hit
+  // set on it, whatever its VMM (ivmm < MMBoardMap::NVMM)
   void SetTrigTime(int bcid, double tdo, int iboard, int ivmm);    
   void SetTrigL0BCID(int bcid, int iboard, int ivmm);  // l0 bcid
-  int TrigTimeBCID(int iboard, int ivmm);
-  int TrigTimeL0BCID(int iboard, int ivmm);
-  double TrigTimeTDO(int iboard, int ivmm);
+  int TrigTimeBCID(int iboard, int ivmm) const;
+  int TrigTimeL0BCID(int iboard, int ivmm) const;
+  double TrigTimeTDO(int iboard, int ivmm) const;
+  // trigger time of one VMM: its own trigger hit, the board's if none
+  int TrigTimeBCIDVMM(int iboard, int ivmm) const;
+  int TrigTimeL0BCIDVMM(int iboard, int ivmm) const;
+  double TrigTimeTDOVMM(int iboard, int ivmm) const;
 
   void SetEventNum(std::vector<int> evt);    
   int EventNum(int ib, int ivmm);
+
+  // trigger times, event numbers and time of another event
+  // (the copy constructor and operator = only copy hits)
+  void CopyTrigTime(const MMEventHits& evt_hits);
+  // trigger times of one board (MMFE8 board id) only
+  void CopyTrigTime(const MMEventHits& evt_hits, int iboard);
   
   friend class PDOToCharge;
   friend class TDOToTime;
@@ -57,25 +74,38 @@ public:
 private:
   std::vector<MMFE8Hits*> m_boards;
   double m_time;
-  std::vector<int> m_bcid = {-1, -1, -1, -1,
-                             -1, -1, -1, -1};
-  std::vector<int> m_l0bcid = {-1, -1, -1, -1,
-                             -1, -1, -1, -1};
-  std::vector<double> m_tdo = {-1, -1, -1, -1,
-                               -1, -1, -1, -1};
+
+  // rows are MMBoardMap slots (last row: unmapped boards);
+  // per board, then per VMM with its own trigger hit
+  int    m_board_bcid[MMBoardMap::NBOARD+1];
+  int    m_board_l0bcid[MMBoardMap::NBOARD+1];
+  double m_board_tdo[MMBoardMap::NBOARD+1];
+  int    m_bcid[MMBoardMap::NBOARD+1][MMBoardMap::NVMM];
+  int    m_l0bcid[MMBoardMap::NBOARD+1][MMBoardMap::NVMM];
+  double m_tdo[MMBoardMap::NBOARD+1][MMBoardMap::NVMM];
+  // VMMs with their own trigger hit, one bit per VMM
+  int    m_trig_vmms[MMBoardMap::NBOARD+1];
+  int    m_l0_vmms[MMBoardMap::NBOARD+1];
   std::vector<int> m_evt;
+
+  void ClearTrigTime();
 };
 
-inline MMEventHits::MMEventHits() {}
+inline MMEventHits::MMEventHits() {
+  ClearTrigTime();
+}
 
 inline MMEventHits::MMEventHits(const MMHit& hit){
+  ClearTrigTime();
   AddHit(hit);
 }
 inline MMEventHits::MMEventHits(const MMFE8Hits& hits){
+  ClearTrigTime();
   AddHits(hits);
 }
 
 inline MMEventHits::MMEventHits(const MMEventHits& evt_hits){
+  ClearTrigTime();
   int Nboard = evt_hits.GetNBoards();
   for(int i = 0; i < Nboard; i++)
     AddHits(evt_hits[i]);
@@ -87,6 +117,40 @@ inline MMEventHits::~MMEventHits(){
     delete m_boards[i];
 }
 
+inline MMEventHits& MMEventHits::operator = (const MMEventHits& evt_hits){
+  if(this == &evt_hits)
+    return *this;
+  Clear();
+  int Nboard = evt_hits.GetNBoards();
+  for(int i = 0; i < Nboard; i++)
+    AddHits(evt_hits[i]);
+  return *this;
+}
+
+inline void MMEventHits::Clear(){
+  int N = GetNBoards();
+  for(int i = 0; i < N; i++)
+    delete m_boards[i];
+  m_boards.clear();
+  m_evt.clear();
+  ClearTrigTime();
+}
+
+inline void MMEventHits::ClearTrigTime(){
+  for(int b = 0; b <= MMBoardMap::NBOARD; b++){
+    m_board_bcid[b] = -1;
+    m_board_l0bcid[b] = -1;
+    m_board_tdo[b] = -1;
+    for(int v = 0; v < MMBoardMap::NVMM; v++){
+      m_bcid[b][v] = -1;
+      m_l0bcid[b][v] = -1;
+      m_tdo[b][v] = -1;
+    }
+    m_trig_vmms[b] = 0;
+    m_l0_vmms[b] = 0;
+  }
+}
+
 inline bool MMEventHits::AddHit(const MMHit& hit){
   int Nboard = GetNBoards();
   for(int i = 0; i < Nboard; i++)
@@ -128,7 +192,7 @@ inline int MMEventHits::MMFE8(int iboard) const {
   if(iboard < 0 || iboard >= GetNBoards())
     return -1;
 
-  return m_boards[0]->MMFE8();
+  return m_boards[iboard]->MMFE8();
 }
 
 inline int MMEventHits::GetNBoards() const {
@@ -170,42 +234,77 @@ inline double MMEventHits::Time(){
 }
 
 inline void MMEventHits::SetTrigTime(int bcid, double tdo, int iboard, int ivmm){
-  if (ivmm > 1){
-    std::cout << "Need to add more than 1 vmm per board handling! Error!" << std::endl;
-  }
-  m_bcid[iboard] = bcid;
-  m_tdo[iboard] = tdo;
+  int b = MMBoardMap::Slot(iboard);
+  m_board_bcid[b] = bcid;
+  m_board_tdo[b] = tdo;
+  m_trig_vmms[b] |= 1 << ivmm;
+  m_bcid[b][ivmm] = bcid;
+  m_tdo[b][ivmm] = tdo;
 }
 
 inline void MMEventHits::SetTrigL0BCID(int bcid, int iboard, int ivmm){
-  if (ivmm > 1){
-    std::cout << "Need to add more than 1 vmm per board handling! Error!" << std::endl;
-  }
-  m_l0bcid[iboard] = bcid;
+  int b = MMBoardMap::Slot(iboard);
+  m_board_l0bcid[b] = bcid;
+  m_l0_vmms[b] |= 1 << ivmm;
+  m_l0bcid[b][ivmm] = bcid;
 }
 
-inline int MMEventHits::TrigTimeBCID(int iboard, int ivmm){
-  if (ivmm > 1){
-    std::cout << "Need to add more than 1 vmm per board handling! Error!" << std::endl;
-    return -1;
-  }
-  return m_bcid[iboard]; //only ok for now
+inline int MMEventHits::TrigTimeBCID(int iboard, int ivmm) const {
+  return m_board_bcid[MMBoardMap::Slot(iboard)];
 }
 
-inline int MMEventHits::TrigTimeL0BCID(int iboard, int ivmm){
-  if (ivmm > 1){
-    std::cout << "Need to add more than 1 vmm per board handling! Error!" << std::endl;
-    return -1;
+inline int MMEventHits::TrigTimeL0BCID(int iboard, int ivmm) const {
+  return m_board_l0bcid[MMBoardMap::Slot(iboard)];
+}
+
+inline double MMEventHits::TrigTimeTDO(int iboard, int ivmm) const {
+  return m_board_tdo[MMBoardMap::Slot(iboard)];
+}
+
+inline int MMEventHits::TrigTimeBCIDVMM(int iboard, int ivmm) const {
+  int b = MMBoardMap::Slot(iboard);
+  return ((m_trig_vmms[b] >> ivmm) & 1) ? m_bcid[b][ivmm] : m_board_bcid[b];
+}
+
+inline int MMEventHits::TrigTimeL0BCIDVMM(int iboard, int ivmm) const {
+  int b = MMBoardMap::Slot(iboard);
+  return ((m_l0_vmms[b] >> ivmm) & 1) ? m_l0bcid[b][ivmm] : m_board_l0bcid[b];
+}
+
+inline double MMEventHits::TrigTimeTDOVMM(int iboard, int ivmm) const {
+  int b = MMBoardMap::Slot(iboard);
+  return ((m_trig_vmms[b] >> ivmm) & 1) ? m_tdo[b][ivmm] : m_board_tdo[b];
+}
+
+inline void MMEventHits::CopyTrigTime(const MMEventHits& evt_hits){
+  for(int b = 0; b <= MMBoardMap::NBOARD; b++){
+    m_board_bcid[b] = evt_hits.m_board_bcid[b];
+    m_board_l0bcid[b] = evt_hits.m_board_l0bcid[b];
+    m_board_tdo[b] = evt_hits.m_board_tdo[b];
+    for(int v = 0; v < MMBoardMap::NVMM; v++){
+      m_bcid[b][v] = evt_hits.m_bcid[b][v];
+      m_l0bcid[b][v] = evt_hits.m_l0bcid[b][v];
+      m_tdo[b][v] = evt_hits.m_tdo[b][v];
+    }
+    m_trig_vmms[b] = evt_hits.m_trig_vmms[b];
+    m_l0_vmms[b] = evt_hits.m_l0_vmms[b];
   }
-  return m_l0bcid[iboard]; //only ok for now
+  m_evt = evt_hits.m_evt;
+  m_time = evt_hits.m_time;
 }
 
-inline double MMEventHits::TrigTimeTDO(int iboard, int ivmm){
-  if (ivmm > 1){
-    std::cout << "Need to add more than 1 vmm per board handling! Error!" << std::endl;
-    return -1;
+inline void MMEventHits::CopyTrigTime(const MMEventHits& evt_hits, int iboard){
+  int b = MMBoardMap::Slot(iboard);
+  m_board_bcid[b] = evt_hits.m_board_bcid[b];
+  m_board_l0bcid[b] = evt_hits.m_board_l0bcid[b];
+  m_board_tdo[b] = evt_hits.m_board_tdo[b];
+  for(int v = 0; v < MMBoardMap::NVMM; v++){
+    m_bcid[b][v] = evt_hits.m_bcid[b][v];
+    m_l0bcid[b][v] = evt_hits.m_l0bcid[b][v];
+    m_tdo[b][v] = evt_hits.m_tdo[b][v];
   }
-  return m_tdo[iboard]; //only ok for now
+  m_trig_vmms[b] = evt_hits.m_trig_vmms[b];
+  m_l0_vmms[b] = evt_hits.m_l0_vmms[b];
 }
 
 inline void MMEventHits::SetEventNum(std::vector<int> evt){
@@ -0,0 +1,227 @@
+///
+///  \file   MMEventIndex.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMEventIndex_HH
+#define MMEventIndex_HH
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+
+#include <sys/stat.h>
+
+#include <Rtypes.h>
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMEventIndex class
+//
+// Trigger counter -> entries of a run, kept
+// next to the input as a sidecar file
+// (input + ".idx") so that single events are
+// found without reading the run. Build()
+// makes one (counter, entry) record per board
+// counter of each entry (counter branches
+// only; boards that disagree give several
+// records, and a counter that wraps around
+// several entries), sorted by counter. The
+// sidecar holds the size and modification
+// time of the input and is ignored once the
+// input changes.
+//
+// Sidecar (native endian):
+//   MMEventIndexHeader
+//   Nrecord x MMEventIndexRecord (sorted)
+///////////////////////////////////////////////
+
+static const char     MMIndex_magic[8] = {'M','M','I','D','X','\0','\0','\0'};
+static const uint32_t MMIndex_version  = 1;
+
+struct MMEventIndexHeader {
+  char     magic[8];
+  uint32_t version;
+  int32_t  reserved;
+  uint64_t input_size;
+  int64_t  input_mtime;
+  uint64_t Nentry;
+  uint64_t Nrecord;
+};
+
+struct MMEventIndexRecord {
+  int32_t counter;
+  int32_t reserved;
+  int64_t entry;
+
+  bool operator < (const MMEventIndexRecord& other) const {
+    return (counter != other.counter) ? counter < other.counter : entry < other.entry;
+  }
+};
+
+class MMEventIndex {
+
+public:
+  MMEventIndex();
+  ~MMEventIndex() {}
+
+  static string SidecarName(const string& input);
+
+  // counter pass over all entries of DATA
+  template <class DATA_T>
+  Long64_t Build(DATA_T* DATA);
+
+  // the sidecar of input, false if missing or stale
+  bool Load(const string& input);
+  bool Save(const string& input) const;
+  void Clear();
+
+  // -1 if neither built nor loaded
+  Long64_t GetNEntries() const;
+  Long64_t GetNRecords() const;
+
+  // appends the entries with this counter, increasing
+  int Find(int counter, vector<Long64_t>& entries) const;
+
+private:
+  Long64_t m_Nentry;
+  vector<MMEventIndexRecord> m_records;
+
+  static bool Stat(const string& input, uint64_t& size, int64_t& mtime);
+};
+
+inline MMEventIndex::MMEventIndex(){
+  m_Nentry = -1;
+}
+
+inline string MMEventIndex::SidecarName(const string& input){
+  return input + ".idx";
+}
+
+inline bool MMEventIndex::Stat(const string& input, uint64_t& size, int64_t& mtime){
+  struct stat st;
+  if(stat(input.c_str(), &st) != 0)
+    return false;
+  size = st.st_size;
+  mtime = st.st_mtime;
+  return true;
+}
+
+template <class DATA_T>
+inline Long64_t MMEventIndex::Build(DATA_T* DATA){
+  Clear();
+  vector<int> boards, counters;
+  MMEventIndexRecord record;
+  record.reserved = 0;
+  Long64_t Nentry = DATA->GetNEntries();
+  m_records.reserve(Nentry);
+  for(Long64_t entry = 0; entry < Nentry; entry++){
+    DATA->GetBoardCounters(entry, boards, counters);
+    record.entry = entry;
+    for(int b = 0; b < int(counters.size()); b++){
+      if(counters[b] < 0 || std::find(counters.begin(), counters.begin()+b, counters[b]) != counters.begin()+b)
+        continue;
+      record.counter = counters[b];
+      m_records.push_back(record);
+    }
+  }
+  std::sort(m_records.begin(), m_records.end());
+  m_Nentry = Nentry;
+  return m_records.size();
+}
+
+inline bool MMEventIndex::Load(const string& input){
+  Clear();
+  uint64_t size;
+  int64_t mtime;
+  if(!Stat(input, size, mtime))
+    return false;
+  string filename = SidecarName(input);
+  FILE* file = fopen(filename.c_str(), "rb");
+  if(!file)
+    return false;
+
+  MMEventIndexHeader header;
+  bool ok = fread(&header, sizeof(header), 1, file) == 1 &&
+    memcmp(header.magic, MMIndex_magic, sizeof(MMIndex_magic)) == 0 &&
+    header.version == MMIndex_version;
+  if(ok && (header.input_size != size || header.input_mtime != mtime)){
+    cout << "MMEventIndex: " << filename << " is older than " << input << ", rebuilding" << endl;
+    ok = false;
+  }
+  if(ok){
+    m_records.resize(header.Nrecord);
+    ok = fread(m_records.data(), sizeof(MMEventIndexRecord), header.Nrecord, file) == header.Nrecord;
+  }
+  fclose(file);
+  if(!ok){
+    Clear();
+    return false;
+  }
+  m_Nentry = header.Nentry;
+  return true;
+}
+
+inline bool MMEventIndex::Save(const string& input) const {
+  MMEventIndexHeader header;
+  memset(&header, 0, sizeof(header));
+  memcpy(header.magic, MMIndex_magic, sizeof(MMIndex_magic));
+  header.version = MMIndex_version;
+  if(m_Nentry < 0 || !Stat(input, header.input_size, header.input_mtime))
+    return false;
+  header.Nentry = m_Nentry;
+  header.Nrecord = m_records.size();
+
+  // a reader sees either no sidecar or a complete one
+  string filename = SidecarName(input);
+  string tmp = filename + ".tmp";
+  FILE* file = fopen(tmp.c_str(), "wb");
+  if(!file){
+    cout << "MMEventIndex: cannot write " << tmp << ", index not kept" << endl;
+    return false;
+  }
+  bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+    fwrite(m_records.data(), sizeof(MMEventIndexRecord), m_records.size(), file) == m_records.size();
+  ok &= (fclose(file) == 0);
+  if(!ok || rename(tmp.c_str(), filename.c_str()) != 0){
+    cout << "MMEventIndex: cannot write " << filename << ", index not kept" << endl;
+    remove(tmp.c_str());
+    return false;
+  }
+  return true;
+}
+
+inline void MMEventIndex::Clear(){
+  m_Nentry = -1;
+  m_records.clear();
+}
+
+inline Long64_t MMEventIndex::GetNEntries() const {
+  return m_Nentry;
+}
+
+inline Long64_t MMEventIndex::GetNRecords() const {
+  return m_records.size();
+}
+
+inline int MMEventIndex::Find(int counter, vector<Long64_t>& entries) const {
+  MMEventIndexRecord key;
+  key.counter = counter;
+  key.entry = -1;
+  int Nfound = 0;
+  for(auto it = std::lower_bound(m_records.begin(), m_records.end(), key);
+      it != m_records.end() && it->counter == counter; ++it, Nfound++)
+    entries.push_back(it->entry);
+  return Nfound;
+}
+
+#endif
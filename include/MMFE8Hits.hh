@@ -62,6 +62,8 @@ public:
 private:
   std::vector<MMLinkedHit*> m_hits;
 
+  int LowerBound(double ch) const;
+
   friend class PDOToCharge;
   friend class TDOToTime;
 };
@@ -121,20 +123,31 @@ inline bool MMFE8Hits::IsSameMMFE8(const MMFE8Hits& hits) const {
   return false;
 }
 
+// first hit with channel >= ch (hits are kept sorted by channel);
+// readout order is mostly increasing, so check the end first
+inline int MMFE8Hits::LowerBound(double ch) const {
+  int N = GetNHits();
+  if(N == 0 || m_hits[N-1]->Channel() < ch)
+    return N;
+  int lo = 0;
+  int hi = N-1;
+  while(lo < hi){
+    int mid = (lo+hi)/2;
+    if(m_hits[mid]->Channel() < ch)
+      lo = mid+1;
+    else
+      hi = mid;
+  }
+  return lo;
+}
+
 inline bool MMFE8Hits::AddHit(const MMHit& hit){
   if(IsSameMMFE8(hit)){
-    int N = GetNHits();
-    for(int i = 0; i < N; i++){
-      if(hit.Channel() < m_hits[i]->Channel()){
-	m_hits.insert(m_hits.begin()+i, new MMLinkedHit(hit));
-	return true;
-      }
-      if(hit.Channel() == m_hits[i]->Channel()){
-	m_hits[i]->AddHit(hit);
-	return true;
-      }	
-    }
-    m_hits.push_back(new MMLinkedHit(hit));
+    int i = LowerBound(hit.Channel());
+    if(i < GetNHits() && hit.Channel() == m_hits[i]->Channel())
+      m_hits[i]->AddHit(hit);
+    else
+      m_hits.insert(m_hits.begin()+i, new MMLinkedHit(hit));
     return true;
   }
   return false;
@@ -142,18 +155,11 @@ inline bool MMFE8Hits::AddHit(const MMHit& hit){
 
 inline bool MMFE8Hits::AddLinkedHit(const MMLinkedHit& hit){
   if(IsSameMMFE8(hit)){
-    int N = GetNHits();
-    for(int i = 0; i < N; i++){
-      if(hit.Channel() < m_hits[i]->Channel()){
-	m_hits.insert(m_hits.begin()+i, new MMLinkedHit(hit));
-	return true;
-      }
-      if(hit.Channel() == m_hits[i]->Channel()){
-	m_hits[i]->AddLinkedHit(hit);
-	return true;
-      }	
-    }
-    m_hits.push_back(new MMLinkedHit(hit));
+    int i = LowerBound(hit.Channel());
+    if(i < GetNHits() && hit.Channel() == m_hits[i]->Channel())
+      m_hits[i]->AddLinkedHit(hit);
+    else
+      m_hits.insert(m_hits.begin()+i, new MMLinkedHit(hit));
     return true;
   }
   return false;
@@ -168,14 +174,7 @@ inline bool MMFE8Hits::AddHits(const MMFE8Hits& hits){
 }
 
 inline bool MMFE8Hits::Contains(const MMHit& hit) const {
-  if(!IsSameMMFE8(hit))
-    return false;
-  int Nhit = GetNHits();
-  for(int i = 0; i < Nhit; i++){
-    if(Get(i).Channel() == hit.Channel())
-      return true;
-  }
-  return false;
+  return GetIndex(hit) >= 0;
 }
 
 inline bool MMFE8Hits::ContainsTP(const TPHit& hit) const {
@@ -203,11 +202,9 @@ inline bool MMFE8Hits::ContainsTP(const MMHit& hit) const {
 inline int MMFE8Hits::GetIndex(const MMHit& hit) const {
   if(!IsSameMMFE8(hit))
     return -1;
-  int Nhit = GetNHits();
-  for(int i = 0; i < Nhit; i++){
-    if(Get(i).Channel() == hit.Channel())
-      return i;
-  }
+  int i = LowerBound(hit.Channel());
+  if(i < GetNHits() && Get(i).Channel() == hit.Channel())
+    return i;
   return -1;
 }
 
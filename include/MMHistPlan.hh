@@ -0,0 +1,483 @@
+///
+///  \file   MMHistPlan.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMHistPlan_HH
+#define MMHistPlan_HH
+
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <map>
+#include <cstdlib>
+
+#include <TString.h>
+#include <TH1D.h>
+#include <TH2D.h>
+
+#include "include/MMChannelSketch.hh"
+
+using namespace std;
+
+// points of the event loop where histograms are filled
+enum MMHistStage { kStageEvent = 0, kStageTrigger, kStageHit, kStageTrigHit, kStageStripHit,
+                   kStageGoodHit, kStageBoard, kStageCluster, kStageClusterFid, kStageTrack,
+                   kStageTrackBoard, kStageTrackNarrow, kStageTrackMid, kStageTrackWide,
+                   kNStage };
+
+// quantities the loop provides at those points
+enum MMHistVar { kVarEvt = 0, kVarDBCIDL0, kVarDBCIDRel,
+                 kVarBoard, kVarChannel, kVarPDO, kVarTDO, kVarBCID, kVarDBCID, kVarLinked,
+                 kVarCharge, kVarTDOC, kVarTime, kVarZpos,
+                 kVarPDOGain, kVarPDOPed, kVarTDOGain, kVarTDOPed,
+                 kVarNClus, kVarNHits,
+                 kVarX, kVarNStrips, kVarHoles,
+                 kVarDX, kVarAbsDX, kVarX0, kVarX1, kVarNStrips0, kVarNStrips1, kVarNStripsMax,
+                 kVarHoles0, kVarHoles1,
+                 kNVar };
+
+///////////////////////////////////////////////
+// MMHistPlan class
+//
+// Histograms of the analysis as data, one
+// per line:
+//
+//   h1 <name> <stage> <x> <axis> [title]
+//   h2 <name> <stage> <x> <axis> <y> <axis> [title]
+//   sketch <name> <stage> <x> [title]
+//   use default|dense [name]
+//
+// (lines starting with # are comments).
+// <axis> is "nbins min max", or "boards" for
+// one bin per layer index. A name with %i is
+// booked for each board and filled with the
+// board of the hit, cluster or track side;
+// a sketch is per strip (MMChannelSketch).
+// "use" pulls in the built-in definitions
+// (all of them, or the one named). A later
+// definition of a name replaces the earlier.
+//
+// Book() creates only the planned histograms
+// in the maps of the job and compiles the
+// fill lists of each stage, keeping the map
+// slots (so swapped histograms are followed).
+// The loop skips stages that are not
+// Active() and computes a quantity only if
+// the plan Uses() it
+///////////////////////////////////////////////
+
+class MMHistPlan {
+
+public:
+  MMHistPlan();
+  ~MMHistPlan() {}
+
+  bool Load(const string& filename);
+  bool LoadText(const string& text, const string& source);
+  bool Has(const string& name) const;
+  int GetNDefinitions() const;
+
+  // returns the number of histograms and sketches booked
+  int Book(map<string, TH1D*>& h1, map<string, TH2D*>& h2,
+           map<string, MMChannelSketch*>& sk, int nboards);
+
+  bool Active(int stage) const;
+  bool Uses(int var) const;
+
+  // every entry of the stage, the %i ones for board
+  void Fill(int stage, const double* v, int board = -1) const;
+  // only the %i entries of the stage, for board
+  void FillBoard(int stage, const double* v, int board) const;
+
+  static int StageIndex(const string& name);
+  static int VarIndex(const string& name);
+  static const char* StageName(int stage);
+  static const char* VarName(int var);
+
+private:
+  struct Axis {
+    bool boards;
+    int nbins;
+    double min;
+    double max;
+  };
+  struct Definition {
+    string kind;
+    string name;
+    int stage;
+    int x;
+    int y;
+    Axis xaxis;
+    Axis yaxis;
+    string title;
+    string where;
+  };
+  struct FillEntry {
+    int x;
+    int y;
+    bool per_board;
+    vector<TH1D**> slot1;
+    vector<TH2D**> slot2;
+    MMChannelSketch* sketch;
+  };
+
+  vector<Definition> m_defs;
+  vector<FillEntry> m_stages[kNStage];
+  bool m_uses[kNVar];
+
+  static bool Provides(int stage, int var, bool per_board);
+  bool ParseAxis(istringstream& fields, Axis& axis) const;
+  void Add(const Definition& def);
+  void Run(const FillEntry& entry, const double* v, int board) const;
+};
+
+// the histograms formerly booked by hand in RunTBAnalysis.C
+static const char* MMHistPlan_default =
+  "h2 dtrigBCID_vs_evt      event    evt 10000 -0.5 9999.5 dbcid_l0  8191 -4095.5 4095.5 dtrigBCID_vs_evt\n"
+  "h2 dtrigBCIDrel_vs_evt   trigger  evt 10000 -0.5 9999.5 dbcid_rel 8191 -4095.5 4095.5 dtrigBCIDrel_vs_evt\n"
+  "h2 trighits_vs_board     trig_hit board boards linked 32 -0.5 31.5 ;MMFE number;hits;Events\n"
+  "h1 tdo_gain              good_hit tdo_gain 100    0    3 tdo_gain\n"
+  "h1 tdo_ped               good_hit tdo_ped  100  -10   50 tdo_ped\n"
+  "h1 pdo_gain              good_hit pdo_gain 100    0   30 pdo_gain\n"
+  "h1 pdo_ped               good_hit pdo_ped  100 -100  300 pdo_ped\n"
+  "sketch strip_pdo_vs_ch     hit       pdo    PDO [counts]\n"
+  "sketch strip_tdo_vs_ch     hit       tdo    TDO [counts]\n"
+  "sketch strip_dbc_vs_ch     strip_hit dbcid  #Delta BCID\n"
+  "sketch strip_q_vs_ch       good_hit  charge Charge [fC]\n"
+  "sketch strip_tdoc_vs_ch    good_hit  tdoc   TDO corr. [ns]\n"
+  "sketch strip_time_vs_ch    good_hit  time   Time [ns]\n"
+  "sketch strip_zpos_vs_ch    good_hit  zpos   z_{drift} [mm]\n"
+  "sketch strip_bcid_vs_ch    good_hit  bcid   BCID\n"
+  "sketch strip_dbc_vs_ch_cut good_hit  dbcid  #Delta BCID\n"
+  "h2 clus_vs_board         board    board boards nclus 32 -0.5 31.5 ;MMFE number;clusters;Events\n"
+  "h2 hits_vs_board         board    board boards nhits 32 -0.5 31.5 ;MMFE number;strips;Events\n"
+  "h1 x_bary_%i             cluster  x 200 -0.5 40 ;x_{bary}; Events\n"
+  "h2 hits_per_clus_vs_board     cluster     board boards nstrips 66 -0.5 65.5 ;MMFE number;hits in a cluster;Clusters\n"
+  "h2 hits_per_clus_vs_board_fid cluster_fid board boards nstrips 66 -0.5 65.5 ;MMFE number;hits in a cluster;Clusters\n"
+  "h2 clus_vs_board_postsel track_board board boards nclus 32 -0.5 31.5 ;MMFE number;clusters;Events\n"
+  "h1 track_diff01_bary     track    dx 800 -20 20 ;x_{bary,0} - x_{bary,1}; Tracks\n"
+  "h2 x_bary_%i_track_diff01_bary         track x           200 -0.5 40   dx 800 -20 20 ;x_{bary};x_{bary,0} - x_{bary,1}; Events\n"
+  "h2 hits_per_clus_%i_track_diff01_bary  track nstrips      66 -0.5 65.5 dx 800 -20 20 ;hits in a cluster;x_{bary,0} - x_{bary,1}; Events\n"
+  "h2 holes_per_clus_%i_track_diff01_bary track holes        10 -0.5 9.5  dx 800 -20 20 ;holes in a cluster;x_{bary,0} - x_{bary,1}; Events\n"
+  "h2 hits_per_clus_max_track_diff01_bary     track nstrips_max 66 -0.5 65.5 dx     800 -20 20 ;hits in a cluster;x_{bary,0} - x_{bary,1}; Events\n"
+  "h2 hits_per_clus_max_track_abs_diff01_bary track nstrips_max 66 -0.5 65.5 abs_dx 400   0 20 ;hits in a cluster;|x_{bary,0} - x_{bary,1}|; Events\n"
+  "h2 hits_per_clus_0_vs_hits_per_clus_1_fid     track        nstrips0 66 -0.5 65.5 nstrips1 66 -0.5 65.5 ;hits in a cluster 0;hits in a cluster 1;Clusters\n"
+  "h2 hits_per_clus_0_vs_hits_per_clus_1_fid_pm2 track_narrow nstrips0 66 -0.5 65.5 nstrips1 66 -0.5 65.5 ;hits in a cluster 0;hits in a cluster 1;Clusters\n"
+  "h2 hits_per_clus_0_vs_hits_per_clus_1_fid_pm4 track_mid    nstrips0 66 -0.5 65.5 nstrips1 66 -0.5 65.5 ;hits in a cluster 0;hits in a cluster 1;Clusters\n"
+  "h2 hits_per_clus_0_vs_hits_per_clus_1_fid_ge4 track_wide   nstrips0 66 -0.5 65.5 nstrips1 66 -0.5 65.5 ;hits in a cluster 0;hits in a cluster 1;Clusters\n";
+
+// strip vs value TH2Ds (--dense-strip-hists)
+static const char* MMHistPlan_dense =
+  "h2 strip_q_vs_ch_%i       good_hit  channel 64 -0.5 63.5 charge  512    0     128   ;strip number;Charge [fC];strip\n"
+  "h2 strip_pdo_vs_ch_%i     hit       channel 64 -0.5 63.5 pdo     512    0    2048   ;strip number;PDO [counts];strip\n"
+  "h2 strip_tdo_vs_ch_%i     hit       channel 64 -0.5 63.5 tdo     256    0     256   ;strip number;TDO [counts];strip\n"
+  "h2 strip_tdoc_vs_ch_%i    good_hit  channel 64 -0.5 63.5 tdoc    200   -5      60   ;strip number;TDO corr. [ns];strip\n"
+  "h2 strip_time_vs_ch_%i    good_hit  channel 64 -0.5 63.5 time    400 -200     600   ;strip number;Time [ns];strip\n"
+  "h2 strip_zpos_vs_ch_%i    good_hit  channel 64 -0.5 63.5 zpos    150  -10      20   ;strip number;z_{drift} [mm];strip\n"
+  "h2 strip_bcid_vs_ch_%i    good_hit  channel 64 -0.5 63.5 bcid   4096 -0.5    4095   ;strip number;BCID [mm];strip\n"
+  "h2 strip_dbc_vs_ch_%i     strip_hit channel 64 -0.5 63.5 dbcid  8191 -4095.5 4095.5 ;strip number;#Delta BCID [mm];strip\n"
+  "h2 strip_dbc_vs_ch_cut_%i good_hit  channel 64 -0.5 63.5 dbcid  8191 -4095.5 4095.5 ;strip number;#Delta BCID [mm];strip\n";
+
+inline MMHistPlan::MMHistPlan(){
+  for(int v = 0; v < kNVar; v++)
+    m_uses[v] = false;
+}
+
+inline const char* MMHistPlan::StageName(int stage){
+  static const char* names[kNStage] = { "event", "trigger", "hit", "trig_hit", "strip_hit",
+                                        "good_hit", "board", "cluster", "cluster_fid", "track",
+                                        "track_board", "track_narrow", "track_mid", "track_wide" };
+  return (stage >= 0 && stage < kNStage) ? names[stage] : "";
+}
+
+inline const char* MMHistPlan::VarName(int var){
+  static const char* names[kNVar] = { "evt", "dbcid_l0", "dbcid_rel",
+                                      "board", "channel", "pdo", "tdo", "bcid", "dbcid", "linked",
+                                      "charge", "tdoc", "time", "zpos",
+                                      "pdo_gain", "pdo_ped", "tdo_gain", "tdo_ped",
+                                      "nclus", "nhits",
+                                      "x", "nstrips", "holes",
+                                      "dx", "abs_dx", "x0", "x1", "nstrips0", "nstrips1", "nstrips_max",
+                                      "holes0", "holes1" };
+  return (var >= 0 && var < kNVar) ? names[var] : "";
+}
+
+inline int MMHistPlan::StageIndex(const string& name){
+  for(int s = 0; s < kNStage; s++)
+    if(name == StageName(s))
+      return s;
+  return -1;
+}
+
+inline int MMHistPlan::VarIndex(const string& name){
+  for(int v = 0; v < kNVar; v++)
+    if(name == VarName(v))
+      return v;
+  return -1;
+}
+
+// quantities provided at each stage; per_board: the
+// quantities of one side of the track
+inline bool MMHistPlan::Provides(int stage, int var, bool per_board){
+  switch(stage){
+  case kStageEvent:
+  case kStageTrigger:
+    return var <= kVarDBCIDRel;
+  case kStageHit:
+  case kStageTrigHit:
+  case kStageStripHit:
+    return var >= kVarBoard && var <= kVarLinked;
+  case kStageGoodHit:
+    return var >= kVarBoard && var <= kVarTDOPed;
+  case kStageBoard:
+  case kStageTrackBoard:
+    return var == kVarBoard || var == kVarNClus || (stage == kStageBoard && var == kVarNHits);
+  case kStageCluster:
+  case kStageClusterFid:
+    return var == kVarBoard || (var >= kVarX && var <= kVarHoles);
+  default:
+    if(var >= kVarX && var <= kVarHoles)
+      return per_board && stage == kStageTrack;
+    return var >= kVarDX && var <= kVarHoles1;
+  }
+}
+
+inline bool MMHistPlan::Load(const string& filename){
+  ifstream file(filename.c_str());
+  if(!file.is_open()){
+    cout << "MMHistPlan ERROR: cannot open histogram plan " << filename << endl;
+    return false;
+  }
+  stringstream text;
+  text << file.rdbuf();
+  return LoadText(text.str(), filename);
+}
+
+inline bool MMHistPlan::ParseAxis(istringstream& fields, Axis& axis) const {
+  string first;
+  if(!(fields >> first))
+    return false;
+  axis.boards = (first == "boards");
+  axis.nbins = 0;
+  axis.min = axis.max = 0.;
+  if(axis.boards)
+    return true;
+  axis.nbins = atoi(first.c_str());
+  return (fields >> axis.min >> axis.max) && axis.nbins > 0 && axis.max > axis.min;
+}
+
+inline void MMHistPlan::Add(const Definition& def){
+  for(Definition& old: m_defs)
+    if(old.name == def.name){
+      old = def;
+      return;
+    }
+  m_defs.push_back(def);
+}
+
+inline bool MMHistPlan::LoadText(const string& text, const string& source){
+  istringstream lines(text);
+  string line;
+  int iline = 0;
+  bool ok = true;
+  while(getline(lines, line)){
+    iline++;
+    string where = source + ":" + to_string(iline);
+    istringstream fields(line);
+    string kind;
+    if(!(fields >> kind) || kind[0] == '#')
+      continue;
+
+    if(kind == "use"){
+      string set, name;
+      fields >> set >> name;
+      const char* builtin = (set == "default") ? MMHistPlan_default :
+                            (set == "dense")   ? MMHistPlan_dense : nullptr;
+      if(!builtin){
+        cout << "MMHistPlan ERROR: " << where << ": use expects default or dense" << endl;
+        ok = false;
+        continue;
+      }
+      MMHistPlan all;
+      all.LoadText(builtin, "built-in " + set);
+      int Nused = 0;
+      for(const Definition& def: all.m_defs)
+        if(name.empty() || def.name == name){
+          Add(def);
+          Nused++;
+        }
+      if(Nused == 0){
+        cout << "MMHistPlan ERROR: " << where << ": no " << name << " in the " << set << " plan" << endl;
+        ok = false;
+      }
+      continue;
+    }
+
+    Definition def;
+    def.kind = kind;
+    def.where = where;
+    def.x = def.y = -1;
+    string stage, x, y;
+    if(kind != "h1" && kind != "h2" && kind != "sketch"){
+      cout << "MMHistPlan ERROR: " << where << ": unknown kind " << kind << endl;
+      ok = false;
+      continue;
+    }
+    if(!(fields >> def.name >> stage >> x)){
+      cout << "MMHistPlan ERROR: " << where << ": expected " << kind << " <name> <stage> <x> ..." << endl;
+      ok = false;
+      continue;
+    }
+    def.stage = StageIndex(stage);
+    def.x = VarIndex(x);
+    bool good = (def.stage >= 0 && def.x >= 0);
+    if(kind != "sketch")
+      good = good && ParseAxis(fields, def.xaxis);
+    if(kind == "h2")
+      good = good && (fields >> y) && (def.y = VarIndex(y)) >= 0 && ParseAxis(fields, def.yaxis);
+    if(!good){
+      cout << "MMHistPlan ERROR: " << where << ": bad stage, quantity or axis in " << def.name << endl;
+      ok = false;
+      continue;
+    }
+    // the name of a per-board histogram is a printf format: one %i, no other %
+    bool per_board = (def.name.find("%i") != string::npos);
+    int Npercent = 0;
+    for(char c: def.name)
+      Npercent += (c == '%');
+    if(Npercent > 1 || (Npercent == 1 && !per_board)){
+      cout << "MMHistPlan ERROR: " << where << ": " << def.name << ": a name holds at most one %, as %i" << endl;
+      ok = false;
+      continue;
+    }
+    if(!Provides(def.stage, def.x, per_board) || (def.y >= 0 && !Provides(def.stage, def.y, per_board))){
+      cout << "MMHistPlan ERROR: " << where << ": " << def.name << ": " << VarName(def.x)
+           << (def.y >= 0 ? string(" or ") + VarName(def.y) : string(""))
+           << " not available at stage " << stage << endl;
+      ok = false;
+      continue;
+    }
+    if(kind == "sketch" && (def.stage < kStageHit || def.stage > kStageGoodHit || per_board)){
+      cout << "MMHistPlan ERROR: " << where << ": sketches are per strip, at a hit stage, without %i" << endl;
+      ok = false;
+      continue;
+    }
+    if(per_board && (def.stage == kStageEvent || def.stage == kStageTrigger || def.stage > kStageTrackBoard)){
+      cout << "MMHistPlan ERROR: " << where << ": no board at stage " << stage << " for " << def.name << endl;
+      ok = false;
+      continue;
+    }
+    getline(fields, def.title);
+    size_t start = def.title.find_first_not_of(" \t");
+    def.title = (start == string::npos) ? "" : def.title.substr(start);
+    Add(def);
+  }
+  return ok;
+}
+
+inline bool MMHistPlan::Has(const string& name) const {
+  for(const Definition& def: m_defs)
+    if(def.name == name)
+      return true;
+  return false;
+}
+
+inline int MMHistPlan::GetNDefinitions() const {
+  return m_defs.size();
+}
+
+inline int MMHistPlan::Book(map<string, TH1D*>& h1, map<string, TH2D*>& h2,
+                            map<string, MMChannelSketch*>& sk, int nboards){
+  for(int s = 0; s < kNStage; s++)
+    m_stages[s].clear();
+  for(int v = 0; v < kNVar; v++)
+    m_uses[v] = false;
+
+  int Nbook = 0;
+  for(const Definition& def: m_defs){
+    FillEntry entry;
+    entry.x = def.x;
+    entry.y = def.y;
+    entry.per_board = (def.name.find("%i") != string::npos);
+    entry.sketch = nullptr;
+    if(def.kind == "sketch"){
+      sk[def.name] = entry.sketch = new MMChannelSketch(def.name, def.title);
+      Nbook++;
+    } else {
+      Axis ax = def.xaxis, ay = def.yaxis;
+      for(Axis* a: {&ax, &ay})
+        if(a->boards){
+          a->nbins = nboards;
+          a->min = -0.5;
+          a->max = nboards - 0.5;
+        }
+      for(int b = 0; b < (entry.per_board ? nboards : 1); b++){
+        string name = entry.per_board ? string(Form(def.name.c_str(), b)) : def.name;
+        if(def.kind == "h1"){
+          TH1D*& slot = h1[name];
+          slot = new TH1D(name.c_str(), def.title.c_str(), ax.nbins, ax.min, ax.max);
+          entry.slot1.push_back(&slot);
+        } else {
+          TH2D*& slot = h2[name];
+          slot = new TH2D(name.c_str(), def.title.c_str(), ax.nbins, ax.min, ax.max, ay.nbins, ay.min, ay.max);
+          entry.slot2.push_back(&slot);
+        }
+        Nbook++;
+      }
+    }
+    m_uses[def.x] = true;
+    if(def.y >= 0)
+      m_uses[def.y] = true;
+    if(entry.sketch)
+      m_uses[kVarChannel] = true;
+    m_stages[def.stage].push_back(entry);
+  }
+  return Nbook;
+}
+
+inline bool MMHistPlan::Active(int stage) const {
+  return !m_stages[stage].empty();
+}
+
+inline bool MMHistPlan::Uses(int var) const {
+  return m_uses[var];
+}
+
+inline void MMHistPlan::Run(const FillEntry& entry, const double* v, int board) const {
+  if(entry.sketch){
+    if(board >= 0)
+      entry.sketch->Fill(board, v[kVarChannel], v[entry.x]);
+    return;
+  }
+  int k = 0;
+  if(entry.per_board){
+    k = board;
+    if(k < 0 || k >= int(entry.slot1.size() + entry.slot2.size()))
+      return;
+  }
+  if(entry.y < 0)
+    (*entry.slot1[k])->Fill(v[entry.x]);
+  else
+    (*entry.slot2[k])->Fill(v[entry.x], v[entry.y]);
+}
+
+inline void MMHistPlan::Fill(int stage, const double* v, int board) const {
+  for(const FillEntry& entry: m_stages[stage])
+    if(!entry.per_board || board >= 0)
+      Run(entry, v, board);
+}
+
+inline void MMHistPlan::FillBoard(int stage, const double* v, int board) const {
+  for(const FillEntry& entry: m_stages[stage])
+    if(entry.per_board)
+      Run(entry, v, board);
+}
+
+#endif
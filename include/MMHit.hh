@@ -11,6 +11,8 @@
 #ifndef MMHit_HH
 #define MMHit_HH
 
+#include "include/MMBoardMap.hh"
+
 class MMHit {
 
 public:
@@ -378,7 +380,5 @@ inline void MMHit::SetPDOPed(double p){
 }
 
 inline void MMHit::SetMMFE8Index() {
-  m_MMFE8index = -1;
-  if      (m_MMFE8 == 2) m_MMFE8index = 0;
-  else if (m_MMFE8 == 3) m_MMFE8index = 1;
+  m_MMFE8index = MMBoardMap::Index(m_MMFE8);
 }
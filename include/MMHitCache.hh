@@ -0,0 +1,162 @@
+///
+///  \file   MMHitCache.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMHitCache_HH
+#define MMHitCache_HH
+
+#include "include/MMEventHits.hh"
+#include "include/MMClusterAlgo.hh"
+
+using namespace std;
+
+// strip - trigger BCID difference, corrected for the 4096 BCID rollover
+inline int dbcid_fix(int strip_bc, int trig_bc) {
+  int simple = strip_bc - trig_bc;
+  int corr = strip_bc - trig_bc + 4096;
+  int corr2 = strip_bc - trig_bc - 4096;
+  if (fabs(simple) < fabs(corr) && fabs(simple) < fabs(corr2))
+    return simple;
+  else if  (fabs(corr) < fabs(corr2))
+    return corr;
+  else
+    return corr;
+}
+
+///////////////////////////////////////////////
+// MMHitCache class
+//
+// Per-event preprocessing: the good-hit flag
+// and the derived hit quantities (delta BC,
+// trigger time, drift time, rollover-corrected
+// strip - trigger BCID) are evaluated once per
+// hit into per-board arrays, indexed like
+// evt_hits[iboard][ihit], and shared by the
+// clustering and the histogram filling.
+// Nothing here depends on the readout mode:
+// only the BCID decode does (MMReadoutMode.hh)
+///////////////////////////////////////////////
+
+class MMHitCache {
+
+public:
+  // T and recipe as in MMHit::DriftTime
+  MMHitCache(double T = 30., int recipe = 0);
+  ~MMHitCache() {}
+
+  // call after the clustering BCID window is set for the event
+  void Fill(const MMEventHits& evt_hits, const MMClusterAlgo& algo);
+
+  int GetNBoards() const;
+  int GetNHits(int iboard) const;
+
+  const vector<char>& GoodMask(int iboard) const;
+  bool IsGood(int iboard, int ihit) const;
+  double DeltaBC(int iboard, int ihit) const;
+  double TrigTime(int iboard, int ihit) const;
+  double DriftTime(int iboard, int ihit) const;
+  int DBCID(int iboard, int ihit) const;
+
+private:
+  double m_T;
+  int m_recipe;
+  int m_Nboard;
+
+  // one entry per board, reused from event to event
+  vector<vector<char> >   m_good;
+  vector<vector<double> > m_deltaBC;
+  vector<vector<double> > m_trigtime;
+  vector<vector<double> > m_drifttime;
+  vector<vector<int> >    m_dbcid;
+
+  void FillHits(const MMEventHits& evt_hits);
+};
+
+inline MMHitCache::MMHitCache(double T, int recipe){
+  m_T = T;
+  m_recipe = recipe;
+  m_Nboard = 0;
+}
+
+inline void MMHitCache::Fill(const MMEventHits& evt_hits, const MMClusterAlgo& algo){
+  m_Nboard = evt_hits.GetNBoards();
+  if(int(m_good.size()) < m_Nboard){
+    m_good.resize(m_Nboard);
+    m_deltaBC.resize(m_Nboard);
+    m_trigtime.resize(m_Nboard);
+    m_drifttime.resize(m_Nboard);
+    m_dbcid.resize(m_Nboard);
+  }
+
+  for(int b = 0; b < m_Nboard; b++)
+    algo.GoodHitMask(evt_hits[b], m_good[b]);
+
+  FillHits(evt_hits);
+}
+
+inline void MMHitCache::FillHits(const MMEventHits& evt_hits){
+  // half-BC shift of suspicious BCIDs (recipe 2), as MMHit::DriftTime
+  const double shift = (m_recipe == 2) ? 0.5 : 0.;
+
+  for(int b = 0; b < m_Nboard; b++){
+    const MMFE8Hits& hits = evt_hits[b];
+    int Nhit = hits.GetNHits();
+
+    m_deltaBC[b].resize(Nhit);
+    m_trigtime[b].resize(Nhit);
+    m_drifttime[b].resize(Nhit);
+    m_dbcid[b].resize(Nhit);
+
+    for(int i = 0; i < Nhit; i++){
+      const MMHit& hit = hits[i];
+
+      // same arithmetic as MMHit::DeltaBC and MMHit::DriftTime
+      double trigtime = hit.TrigTime();
+      double dbc = hit.TrigBCID() - trigtime/25.0 - hit.BCID();
+      m_trigtime[b][i] = trigtime;
+      m_deltaBC[b][i]  = dbc;
+      m_drifttime[b][i] = m_T - 25*(dbc + shift*hit.SuspiciousBCID()) - hit.Time();
+
+      m_dbcid[b][i] = dbcid_fix(hit.BCID(), evt_hits.TrigTimeBCID(hit.MMFE8(), hit.VMM()));
+    }
+  }
+}
+
+inline int MMHitCache::GetNBoards() const {
+  return m_Nboard;
+}
+
+inline int MMHitCache::GetNHits(int iboard) const {
+  return int(m_good[iboard].size());
+}
+
+inline const vector<char>& MMHitCache::GoodMask(int iboard) const {
+  return m_good[iboard];
+}
+
+inline bool MMHitCache::IsGood(int iboard, int ihit) const {
+  return m_good[iboard][ihit];
+}
+
+inline double MMHitCache::DeltaBC(int iboard, int ihit) const {
+  return m_deltaBC[iboard][ihit];
+}
+
+inline double MMHitCache::TrigTime(int iboard, int ihit) const {
+  return m_trigtime[iboard][ihit];
+}
+
+inline double MMHitCache::DriftTime(int iboard, int ihit) const {
+  return m_drifttime[iboard][ihit];
+}
+
+inline int MMHitCache::DBCID(int iboard, int ihit) const {
+  return m_dbcid[iboard][ihit];
+}
+
+#endif
@@ -0,0 +1,514 @@
+///
+///  \file   MMHoughTracker.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMHoughTracker_HH
+#define MMHoughTracker_HH
+
+#include <iostream>
+#include <vector>
+#include <cmath>
+#include <algorithm>
+
+#include "include/MMClusterList.hh"
+#include "include/MMBoardMap.hh"
+#include "include/MMRunSettings.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMHoughTrack class
+//
+// A track candidate of MMHoughTracker: the
+// clusters it claimed (one per plane, the
+// input of a track fit), the straight-line
+// fit x(z) = x0 + slope*(z - zref) of its X
+// clusters and the y of its stereo clusters
+///////////////////////////////////////////////
+
+struct MMHoughTrack {
+  MMClusterList clusters;
+  double x0;
+  double slope;
+  double zref;
+  double y0;
+  double chi2;  // residuals across the strips, mm^2
+  int NX;
+  int NUV;
+
+  double X(double z) const { return x0 + slope*(z - zref); }
+  int NPlanes() const { return NX + NUV; }
+};
+
+///////////////////////////////////////////////
+// MMHoughTracker class
+//
+// Pattern recognition for events with several
+// clusters per plane. Each X cluster votes in
+// a (slope, x0) accumulator, one vote per
+// slope bin. Every bin pair (x0, x0 + 1 bin)
+// with votes from enough X planes makes a
+// candidate: the nearest X cluster of each
+// plane around its line, a straight-line fit,
+// and the U/V clusters within the strip length
+// of the line that agree on one y. Candidates
+// are ranked by planes, chi2, |slope| and
+// then cluster order (two planes always fit
+// with chi2 = 0), and accepted if none of
+// their clusters is taken yet.
+//
+// Voting is linear in the number of clusters
+// (fixed number of slope bins, votes chained
+// per bin, stereo clusters indexed by
+// position); the number of candidates grows
+// with the density of clusters in the
+// accumulator, no combinations are formed.
+//
+// Plane z and stereo angle are per layer of
+// MMBoardMap, from the conditions of the run
+// (plane_z, plane_stereo; the built-in table
+// holds the octuplet X X U V U V X X, of which
+// the two-board test beam setup uses the
+// first two layers)
+///////////////////////////////////////////////
+
+class MMHoughTracker {
+
+public:
+  // pitch [mm/strip], |slope| range, x0 bin [mm]
+  MMHoughTracker(double pitch = 0.4, double slope_max = 0.5, double x_bin = 2.);
+  ~MMHoughTracker();
+
+  // stereo angle [rad], 0 for an X plane
+  void SetPlane(int layer, double z, double stereo = 0.);
+  // all layers, from MMRunSettings::PlaneZ / PlaneStereo
+  void SetGeometry(const MMRunSettings& settings);
+  // planes required on a candidate
+  void SetMinPlanes(int Nx, int Nuv = 0);
+  // |y| range along the strips and y vote bin [mm]
+  void SetYRange(double y_max, double y_bin = 30.);
+
+  // accepted candidates, most planes first
+  vector<MMHoughTrack> FindTracks(const vector<MMClusterList>& clusters_perboard);
+
+  int GetNSlopeBins() const;
+
+private:
+  struct Point {
+    int layer;
+    double u;  // position across the strips [mm]
+    const MMCluster* clus;
+  };
+  struct Bin {
+    unsigned int planes;  // bit per X layer with a vote
+    int head;             // last vote in the bin, -1 if none
+  };
+  struct Candidate {
+    int point[MMBoardMap::NBOARD];  // per layer, -1 if none
+    int Nplane;
+    double x0;
+    double slope;
+    double y0;
+    double chi2;
+  };
+
+  double m_pitch;
+  double m_slope_max;
+  double m_x_bin;
+  double m_y_max;
+  double m_y_bin;
+  int m_min_x;
+  int m_min_uv;
+
+  double m_z[MMBoardMap::NBOARD];
+  double m_stereo[MMBoardMap::NBOARD];
+  double m_zref;
+  int m_Nslope;
+  double m_dslope;
+  double m_u_bin;
+
+  // per-event work space, grown as needed
+  vector<Point> m_points;
+  vector<char>  m_used;
+  vector<Bin>   m_bins;
+  vector<int>   m_touched;
+  vector<int>   m_vote_point;
+  vector<int>   m_vote_next;
+  vector<int>   m_uhead;  // stereo clusters per u bin from m_u_lo
+  vector<int>   m_unext;
+  double m_u_lo;
+  vector<Candidate> m_candidates;
+
+  void UpdateBinning();
+  bool IsStereo(int layer) const;
+  double XLine(const Candidate& cand, int layer) const;
+  bool MakeCandidate(int slope_bin, double x0, int ix, int Nx, Candidate& cand);
+  void AttachUV(Candidate& cand);
+};
+
+inline MMHoughTracker::MMHoughTracker(double pitch, double slope_max, double x_bin){
+  m_pitch = pitch;
+  m_slope_max = slope_max;
+  m_x_bin = x_bin;
+  m_y_max = 100.;
+  m_y_bin = 30.;
+  m_min_x = 2;
+  m_min_uv = 0;
+  m_u_lo = 0.;
+  SetGeometry(MMRunSettings());
+}
+
+inline MMHoughTracker::~MMHoughTracker() {}
+
+inline void MMHoughTracker::SetPlane(int layer, double z, double stereo){
+  if(layer < 0 || layer >= MMBoardMap::NBOARD)
+    return;
+  m_z[layer] = z;
+  m_stereo[layer] = stereo;
+  UpdateBinning();
+}
+
+inline void MMHoughTracker::SetGeometry(const MMRunSettings& settings){
+  for(int l = 0; l < MMBoardMap::NBOARD; l++){
+    m_z[l] = settings.PlaneZ(l);
+    m_stereo[l] = settings.PlaneStereo(l);
+  }
+  UpdateBinning();
+}
+
+inline void MMHoughTracker::SetMinPlanes(int Nx, int Nuv){
+  m_min_x = std::max(2, Nx);
+  m_min_uv = std::max(0, Nuv);
+}
+
+inline void MMHoughTracker::SetYRange(double y_max, double y_bin){
+  if(y_max > 0.)
+    m_y_max = y_max;
+  if(y_bin > 0.)
+    m_y_bin = y_bin;
+  UpdateBinning();
+}
+
+inline int MMHoughTracker::GetNSlopeBins() const {
+  return m_Nslope;
+}
+
+inline bool MMHoughTracker::IsStereo(int layer) const {
+  return m_stereo[layer] != 0.;
+}
+
+inline double MMHoughTracker::XLine(const Candidate& cand, int layer) const {
+  return cand.x0 + cand.slope*(m_z[layer] - m_zref);
+}
+
+// slope step such that a line moves by at most one x0
+// bin between the reference and the farthest X plane;
+// the stereo u bins span the u range of |y| < y_max
+inline void MMHoughTracker::UpdateBinning(){
+  double zmin = 0., zmax = 0.;
+  double sin_max = 0.;
+  bool first = true;
+  for(int l = 0; l < MMBoardMap::NBOARD; l++){
+    if(IsStereo(l)){
+      sin_max = std::max(sin_max, fabs(sin(m_stereo[l])));
+      continue;
+    }
+    if(first || m_z[l] < zmin) zmin = m_z[l];
+    if(first || m_z[l] > zmax) zmax = m_z[l];
+    first = false;
+  }
+  m_zref = (zmin + zmax)/2.;
+  double half = std::max((zmax - zmin)/2., 1e-6);
+  m_Nslope = 2*int(ceil(m_slope_max*half/m_x_bin)) + 1;
+  m_dslope = 2.*m_slope_max/(m_Nslope - 1);
+  m_u_bin = std::max(m_x_bin, 2.*m_y_max*sin_max);
+}
+
+inline vector<MMHoughTrack> MMHoughTracker::FindTracks(const vector<MMClusterList>& clusters_perboard){
+  vector<MMHoughTrack> tracks;
+
+  // clusters of mapped layers, split in X and U/V
+  m_points.clear();
+  vector<int> xpoints, stereo;
+  double umin = 0., umax = 0.;
+  double smin = 0., smax = 0.;
+  for(const MMClusterList& list: clusters_perboard)
+    for(int c = 0; c < list.GetNCluster(); c++){
+      const MMCluster& clus = list[c];
+      int layer = MMBoardMap::Index(clus.MMFE8());
+      if(layer < 0)
+        continue;
+      Point p;
+      p.layer = layer;
+      p.u = clus.Channel()*m_pitch;
+      p.clus = &clus;
+      if(IsStereo(layer)){
+        if(stereo.empty() || p.u < smin) smin = p.u;
+        if(stereo.empty() || p.u > smax) smax = p.u;
+        stereo.push_back(m_points.size());
+      } else {
+        if(xpoints.empty() || p.u < umin) umin = p.u;
+        if(xpoints.empty() || p.u > umax) umax = p.u;
+        xpoints.push_back(m_points.size());
+      }
+      m_points.push_back(p);
+    }
+  if(int(xpoints.size()) < m_min_x)
+    return tracks;
+
+  // stereo clusters chained per u bin
+  m_u_lo = smin;
+  m_uhead.assign(stereo.empty() ? 0 : int((smax - smin)/m_u_bin) + 1, -1);
+  m_unext.assign(m_points.size(), -1);
+  for(int i: stereo){
+    int iu = int((m_points[i].u - m_u_lo)/m_u_bin);
+    m_unext[i] = m_uhead[iu];
+    m_uhead[iu] = i;
+  }
+
+  // accumulator over the x0 range reachable from the clusters
+  double reach = 0.;
+  for(int i: xpoints)
+    reach = std::max(reach, m_slope_max*fabs(m_z[m_points[i].layer] - m_zref));
+  double x_lo = umin - reach - m_x_bin;
+  int Nx = int((umax + reach + m_x_bin - x_lo)/m_x_bin) + 1;
+  size_t Nbin = size_t(Nx)*m_Nslope;
+  if(m_bins.size() < Nbin){
+    Bin empty = {0u, -1};
+    m_bins.resize(Nbin, empty);
+  }
+  m_touched.clear();
+  m_vote_point.clear();
+  m_vote_next.clear();
+
+  // votes: one per slope bin and X cluster
+  for(int i: xpoints){
+    const Point& p = m_points[i];
+    double dz = m_z[p.layer] - m_zref;
+    for(int s = 0; s < m_Nslope; s++){
+      double slope = -m_slope_max + s*m_dslope;
+      int ix = int((p.u - slope*dz - x_lo)/m_x_bin);
+      if(ix < 0 || ix >= Nx)
+        continue;
+      Bin& bin = m_bins[s*Nx + ix];
+      if(bin.planes == 0u)
+        m_touched.push_back(s*Nx + ix);
+      bin.planes |= (1u << p.layer);
+      m_vote_point.push_back(i);
+      m_vote_next.push_back(bin.head);
+      bin.head = m_vote_point.size() - 1;
+    }
+  }
+
+  // a candidate per bin pair with enough X planes (the
+  // votes of one track can straddle a bin edge)
+  m_candidates.clear();
+  for(int b: m_touched){
+    int s = b/Nx;
+    int ix = b%Nx;
+    unsigned int planes = m_bins[b].planes;
+    if(ix+1 < Nx)
+      planes |= m_bins[b+1].planes;
+    if(__builtin_popcount(planes) < m_min_x)
+      continue;
+    Candidate cand;
+    if(MakeCandidate(s, x_lo + (ix + 1)*m_x_bin, ix, Nx, cand))
+      m_candidates.push_back(cand);
+  }
+
+  // accumulator back to empty, touched bins only
+  for(int b: m_touched){
+    m_bins[b].planes = 0u;
+    m_bins[b].head = -1;
+  }
+
+  // best first, each cluster in one track at most; chi2
+  // compared in 1e-6 mm^2 steps, so that fits equal up to
+  // rounding fall through to the tie-breaks
+  std::sort(m_candidates.begin(), m_candidates.end(),
+            [](const Candidate& a, const Candidate& b){
+              if(a.Nplane != b.Nplane)
+                return a.Nplane > b.Nplane;
+              long long chi2_a = llround(a.chi2*1e6);
+              long long chi2_b = llround(b.chi2*1e6);
+              if(chi2_a != chi2_b)
+                return chi2_a < chi2_b;
+              if(fabs(a.slope) != fabs(b.slope))
+                return fabs(a.slope) < fabs(b.slope);
+              return std::lexicographical_compare(a.point, a.point + MMBoardMap::NBOARD,
+                                                  b.point, b.point + MMBoardMap::NBOARD);
+            });
+  m_used.assign(m_points.size(), 0);
+  for(const Candidate& cand: m_candidates){
+    bool free = true;
+    for(int l = 0; l < MMBoardMap::NBOARD; l++)
+      if(cand.point[l] >= 0 && m_used[cand.point[l]])
+        free = false;
+    if(!free)
+      continue;
+
+    MMHoughTrack track;
+    track.x0 = cand.x0;
+    track.slope = cand.slope;
+    track.zref = m_zref;
+    track.y0 = cand.y0;
+    track.chi2 = cand.chi2;
+    track.NX = 0;
+    track.NUV = 0;
+    for(int l = 0; l < MMBoardMap::NBOARD; l++){
+      if(cand.point[l] < 0)
+        continue;
+      m_used[cand.point[l]] = 1;
+      track.clusters.AddCluster(*m_points[cand.point[l]].clus);
+      if(IsStereo(l))
+        track.NUV++;
+      else
+        track.NX++;
+    }
+    tracks.push_back(track);
+  }
+  return tracks;
+}
+
+// nearest X cluster per plane around the line of the bin
+// pair, straight-line fit, then the U/V clusters
+inline bool MMHoughTracker::MakeCandidate(int s, double x0, int ix, int Nx, Candidate& cand){
+  double slope = -m_slope_max + s*m_dslope;
+  double best_d[MMBoardMap::NBOARD];
+  for(int l = 0; l < MMBoardMap::NBOARD; l++){
+    cand.point[l] = -1;
+    best_d[l] = 1.5*m_x_bin;
+  }
+  for(int jx = std::max(0, ix-1); jx <= std::min(Nx-1, ix+2); jx++)
+    for(int v = m_bins[s*Nx + jx].head; v >= 0; v = m_vote_next[v]){
+      int i = m_vote_point[v];
+      const Point& p = m_points[i];
+      double d = fabs(p.u - x0 - slope*(m_z[p.layer] - m_zref));
+      if(d < best_d[p.layer]){
+        best_d[p.layer] = d;
+        cand.point[p.layer] = i;
+      }
+    }
+
+  double S = 0., Sz = 0., Szz = 0., Su = 0., Szu = 0.;
+  for(int l = 0; l < MMBoardMap::NBOARD; l++){
+    if(cand.point[l] < 0)
+      continue;
+    double z = m_z[l] - m_zref;
+    double u = m_points[cand.point[l]].u;
+    S += 1.; Sz += z; Szz += z*z; Su += u; Szu += z*u;
+  }
+  if(S < m_min_x)
+    return false;
+  double det = S*Szz - Sz*Sz;
+  cand.x0 = (det > 0.) ? (Szz*Su - Sz*Szu)/det : Su/S;
+  cand.slope = (det > 0.) ? (S*Szu - Sz*Su)/det : slope;
+  cand.Nplane = int(S);
+  cand.chi2 = 0.;
+  for(int l = 0; l < MMBoardMap::NBOARD; l++)
+    if(cand.point[l] >= 0){
+      double d = m_points[cand.point[l]].u - XLine(cand, l);
+      cand.chi2 += d*d;
+    }
+
+  int NX = cand.Nplane;
+  AttachUV(cand);
+  return cand.Nplane - NX >= m_min_uv;
+}
+
+// u = x cos(a) + y sin(a) on a stereo plane: the U/V
+// clusters within |y| < y_max of the X line vote for
+// their y, the pair of y bins with most planes is kept
+inline void MMHoughTracker::AttachUV(Candidate& cand){
+  cand.y0 = 0.;
+  if(m_uhead.empty())
+    return;
+
+  const int NYBIN = 64;
+  const int NLOCAL = 4*MMBoardMap::NBOARD;
+  int Nybin = std::min(NYBIN, int(2.*m_y_max/m_y_bin) + 1);
+  int ymask[NYBIN];
+  for(int k = 0; k < Nybin; k++)
+    ymask[k] = 0;
+
+  // stereo clusters in reach of the line, and their y
+  int local[NLOCAL];
+  double ylocal[NLOCAL];
+  int Nlocal = 0;
+  for(int l = 0; l < MMBoardMap::NBOARD; l++){
+    if(!IsStereo(l))
+      continue;
+    double a = m_stereo[l];
+    double u0 = XLine(cand, l)*cos(a);
+    double du = m_y_max*fabs(sin(a));
+    int iu_lo = std::max(0, int(floor((u0 - du - m_u_lo)/m_u_bin)));
+    int iu_hi = std::min(int(m_uhead.size()) - 1, int(floor((u0 + du - m_u_lo)/m_u_bin)));
+    for(int iu = iu_lo; iu <= iu_hi; iu++)
+      for(int i = m_uhead[iu]; i >= 0; i = m_unext[i]){
+        if(m_points[i].layer != l || Nlocal == NLOCAL)
+          continue;
+        double y = (m_points[i].u - u0)/sin(a);
+        if(fabs(y) >= m_y_max)
+          continue;
+        local[Nlocal] = i;
+        ylocal[Nlocal] = y;
+        ymask[std::min(Nybin-1, int((y + m_y_max)/m_y_bin))] |= (1 << l);
+        Nlocal++;
+      }
+  }
+  if(Nlocal == 0)
+    return;
+
+  int best_bin = 0, best_N = 0;
+  for(int k = 0; k < Nybin; k++){
+    int N = __builtin_popcount(ymask[k] | (k+1 < Nybin ? ymask[k+1] : 0));
+    if(N > best_N){
+      best_N = N;
+      best_bin = k;
+    }
+  }
+
+  // nearest cluster per stereo plane to the centre of the pair
+  double ycentre = -m_y_max + (best_bin + 1)*m_y_bin;
+  double best_d[MMBoardMap::NBOARD];
+  for(int l = 0; l < MMBoardMap::NBOARD; l++)
+    best_d[l] = 2.*m_y_bin;
+  for(int k = 0; k < Nlocal; k++){
+    int iy = std::min(Nybin-1, int((ylocal[k] + m_y_max)/m_y_bin));
+    if(iy < best_bin || iy > best_bin+1)
+      continue;
+    int l = m_points[local[k]].layer;
+    double d = fabs(ylocal[k] - ycentre);
+    if(d < best_d[l]){
+      best_d[l] = d;
+      cand.point[l] = local[k];
+    }
+  }
+
+  // y from the mean, u residuals added to the chi2
+  double ysum = 0.;
+  int NUV = 0;
+  for(int l = 0; l < MMBoardMap::NBOARD; l++)
+    if(IsStereo(l) && cand.point[l] >= 0){
+      double a = m_stereo[l];
+      ysum += (m_points[cand.point[l]].u - XLine(cand, l)*cos(a))/sin(a);
+      NUV++;
+    }
+  if(NUV == 0)
+    return;
+  cand.y0 = ysum/NUV;
+  for(int l = 0; l < MMBoardMap::NBOARD; l++)
+    if(IsStereo(l) && cand.point[l] >= 0){
+      double a = m_stereo[l];
+      double d = m_points[cand.point[l]].u - XLine(cand, l)*cos(a) - cand.y0*sin(a);
+      cand.chi2 += d*d;
+    }
+  cand.Nplane += NUV;
+}
+
+#endif
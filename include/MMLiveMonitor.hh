@@ -0,0 +1,262 @@
+///
+///  \file   MMLiveMonitor.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMLiveMonitor_HH
+#define MMLiveMonitor_HH
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+
+#include <TROOT.h>
+#include <TFile.h>
+#include <TH1D.h>
+#include <TH2D.h>
+#include <THttpServer.h>
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMLiveMonitor class
+//
+// Live view of a few histograms while the
+// event loop runs. Each monitored histogram
+// gets two delta buffers; the event loop
+// fills the active one through its own map
+// slot, which Monitor() points at the buffer.
+// A snapshot thread periodically asks for a
+// swap; the loop answers at its next Sync()
+// (one atomic load otherwise) by pointing the
+// slots at the other buffer, and never waits.
+// The thread then adds the retired buffer to
+// the published histogram (the original
+// object), resets it, and serves the
+// published set with THttpServer on the
+// loopback interface and/or writes it to a
+// rolling snapshot file (temporary file,
+// then rename). Stop() joins the thread, adds
+// what is left and restores the slots, so the
+// job writes the full histograms as usual
+///////////////////////////////////////////////
+
+class MMLiveMonitor {
+
+public:
+  MMLiveMonitor();
+  ~MMLiveMonitor();
+
+  // histograms of the loop, by their map slot (not moved
+  // while monitored); only before Start()
+  void Monitor(TH1D*& slot);
+  void Monitor(TH2D*& slot);
+  int GetNMonitored() const;
+
+  // port > 0: http://localhost:port/live/, file: rolling
+  // snapshot; published every period seconds
+  bool Start(int port, const string& file, double period = 2.);
+  void Stop();
+  bool IsRunning() const;
+
+  // event loop, between events
+  void Sync();
+
+  // published snapshots so far
+  int GetNSnapshots() const;
+
+private:
+  struct Entry {
+    TH1* pub;
+    TH1* delta[2];
+    TH1D** slot1;
+    TH2D** slot2;
+  };
+
+  vector<Entry> m_entries;
+  int m_active;         // buffer filled by the loop
+  int m_port;
+  string m_file;
+  double m_period;
+  thread m_thread;
+  bool m_running;
+  atomic<bool> m_request; // thread -> loop: swap at the next Sync()
+  atomic<bool> m_swapped; // loop -> thread: the other buffer is free
+  atomic<bool> m_stop;
+  atomic<int>  m_Nsnapshot;
+
+  void Add(TH1* hist, TH1D** slot1, TH2D** slot2);
+  void Point(int buffer);
+  void Run();
+  void Merge(int buffer);
+  void WriteSnapshot() const;
+};
+
+inline MMLiveMonitor::MMLiveMonitor()
+  : m_request(false), m_swapped(false), m_stop(false), m_Nsnapshot(0) {
+  m_active = 0;
+  m_port = 0;
+  m_period = 2.;
+  m_running = false;
+}
+
+inline MMLiveMonitor::~MMLiveMonitor(){
+  Stop();
+}
+
+inline void MMLiveMonitor::Add(TH1* hist, TH1D** slot1, TH2D** slot2){
+  if(!hist || m_running)
+    return;
+  Entry entry;
+  entry.pub = hist;
+  entry.slot1 = slot1;
+  entry.slot2 = slot2;
+  for(int b = 0; b < 2; b++){
+    entry.delta[b] = (TH1*) hist->Clone(Form("%s_live%i", hist->GetName(), b));
+    entry.delta[b]->SetDirectory(0);
+    entry.delta[b]->Reset();
+  }
+  m_entries.push_back(entry);
+}
+
+inline void MMLiveMonitor::Monitor(TH1D*& slot){
+  Add(slot, &slot, nullptr);
+}
+
+inline void MMLiveMonitor::Monitor(TH2D*& slot){
+  Add(slot, nullptr, &slot);
+}
+
+inline int MMLiveMonitor::GetNMonitored() const {
+  return m_entries.size();
+}
+
+inline void MMLiveMonitor::Point(int buffer){
+  for(Entry& entry: m_entries){
+    TH1* hist = (buffer < 0) ? entry.pub : entry.delta[buffer];
+    if(entry.slot1)
+      *entry.slot1 = (TH1D*) hist;
+    else
+      *entry.slot2 = (TH2D*) hist;
+  }
+}
+
+inline bool MMLiveMonitor::Start(int port, const string& file, double period){
+  if(m_running || m_entries.empty() || (port <= 0 && file.empty()))
+    return false;
+  m_port = port;
+  m_file = file;
+  m_period = (period > 0.) ? period : 2.;
+  m_active = 0;
+  m_request = false;
+  m_swapped = false;
+  m_stop = false;
+  Point(m_active);
+
+  ROOT::EnableThreadSafety();
+  m_running = true;
+  m_thread = thread(&MMLiveMonitor::Run, this);
+  return true;
+}
+
+inline bool MMLiveMonitor::IsRunning() const {
+  return m_running;
+}
+
+inline void MMLiveMonitor::Sync(){
+  if(!m_request.load(memory_order_acquire))
+    return;
+  m_active ^= 1;
+  Point(m_active);
+  m_request.store(false, memory_order_relaxed);
+  m_swapped.store(true, memory_order_release);
+}
+
+inline void MMLiveMonitor::Merge(int buffer){
+  for(Entry& entry: m_entries){
+    entry.pub->Add(entry.delta[buffer]);
+    entry.delta[buffer]->Reset();
+  }
+}
+
+inline void MMLiveMonitor::WriteSnapshot() const {
+  string tmp = m_file + ".tmp";
+  TFile* f = new TFile(tmp.c_str(), "RECREATE");
+  if(!f || f->IsZombie()){
+    delete f;
+    return;
+  }
+  f->cd();
+  for(const Entry& entry: m_entries)
+    entry.pub->Write();
+  f->Close();
+  delete f;
+  // readers see either the previous or the new snapshot
+  rename(tmp.c_str(), m_file.c_str());
+}
+
+inline void MMLiveMonitor::Run(){
+  // the server answers requests only in the thread that made
+  // it, and that thread is the only one reading the published set
+  THttpServer* server = nullptr;
+  if(m_port > 0){
+    server = new THttpServer(Form("http:%d?loopback", m_port));
+    server->SetTimer(0, true);
+    server->SetReadOnly(true);
+    for(Entry& entry: m_entries)
+      server->Register("/live", entry.pub);
+    cout << "MMLiveMonitor: " << m_entries.size() << " histograms at http://localhost:" << m_port << "/live/" << endl;
+  }
+  if(!m_file.empty())
+    cout << "MMLiveMonitor: " << m_entries.size() << " histograms every " << m_period << " s to " << m_file << endl;
+
+  typedef chrono::steady_clock clock;
+  clock::time_point next = clock::now() + chrono::duration_cast<clock::duration>(chrono::duration<double>(m_period));
+  while(!m_stop.load()){
+    if(server)
+      server->ProcessRequests();
+    this_thread::sleep_for(chrono::milliseconds(20));
+    if(m_swapped.load(memory_order_acquire)){
+      m_swapped.store(false, memory_order_relaxed);
+      Merge(m_active ^ 1);
+      if(!m_file.empty())
+        WriteSnapshot();
+      m_Nsnapshot++;
+    }
+    // one swap in flight at a time: the retired buffer must be
+    // merged before the loop may be asked to retire the other
+    if(clock::now() >= next && !m_request.load() && !m_swapped.load()){
+      m_request.store(true, memory_order_release);
+      next = clock::now() + chrono::duration_cast<clock::duration>(chrono::duration<double>(m_period));
+    }
+  }
+  delete server;
+}
+
+inline void MMLiveMonitor::Stop(){
+  if(!m_running)
+    return;
+  m_stop = true;
+  m_thread.join();
+  m_running = false;
+  // the loop is done: both buffers go to the published set
+  Merge(0);
+  Merge(1);
+  Point(-1);
+  m_request = false;
+  m_swapped = false;
+}
+
+inline int MMLiveMonitor::GetNSnapshots() const {
+  return m_Nsnapshot.load();
+}
+
+#endif
@@ -0,0 +1,369 @@
+///
+///  \file   MMOutputMerger.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMOutputMerger_HH
+#define MMOutputMerger_HH
+
+#include <set>
+
+#include <TFile.h>
+#include <TTree.h>
+#include <TDirectory.h>
+#include <TKey.h>
+#include <TH1.h>
+
+#include "include/MMChannelSketch.hh"
+#include "include/MMAlignment.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMOutputMerger class
+//
+// Combines RunTBAnalysis output files: the
+// histograms of a given directory are summed
+// by name, in the order the files are added.
+//
+// Shard outputs (--shard k/N) are put back in
+// entry order from their analysis_info tree,
+// so that the merge of all shards reproduces
+// the output of a single full-range job
+///////////////////////////////////////////////
+
+class MMOutputMerger {
+
+public:
+  MMOutputMerger();
+  ~MMOutputMerger();
+
+  bool AddFile(const string& filename);
+  int GetNFiles() const;
+
+  // sums every histogram found in dirname of all files
+  // and writes the sums into the same directory of fout
+  int MergeHistograms(TFile* fout, const string& dirname = "histograms");
+
+  // merges the per-strip quantile sketches (MMChannelSketch
+  // state trees) of dirname and writes the merged state and
+  // summary graphs into the same directory of fout
+  int MergeSketches(TFile* fout, const string& dirname = "sketches");
+
+  // merges the alignment statistics (MMAlignment state
+  // trees) of dirname; returns the number of files read
+  int MergeAlignment(TFile* fout, const string& dirname = "alignment");
+
+  // union of the event displays, ordered by event number;
+  // names ending in capped_suffix are limited to the first
+  // max_capped events, as the event loop does
+  int MergeEventDisplays(TFile* fout, const string& dirname = "event_displays",
+                         const string& capped_suffix = "_pm2", int max_capped = 30);
+
+  // orders files by first entry and checks that the
+  // shards are from one run and cover a contiguous range
+  bool SortShards();
+
+  // full shard merge: analysis_info, event displays,
+  // sketches, alignment statistics and every other
+  // top-level directory summed as histograms
+  bool MergeShards(TFile* fout);
+
+private:
+  vector<TFile*> m_files;
+  vector<string> m_names;
+
+  bool GetShardInfo(TFile* f, int& run, Long64_t& first, Long64_t& last, Long64_t& N) const;
+  static int EventNumber(const string& name);
+
+};
+
+inline MMOutputMerger::MMOutputMerger() {}
+
+inline MMOutputMerger::~MMOutputMerger(){
+  for(auto f: m_files){
+    f->Close();
+    delete f;
+  }
+}
+
+inline bool MMOutputMerger::AddFile(const string& filename){
+  TFile* f = new TFile(filename.c_str(), "READ");
+  if(!f || f->IsZombie()){
+    cout << "MMOutputMerger ERROR: unable to open " << filename << endl;
+    delete f;
+    return false;
+  }
+  m_files.push_back(f);
+  m_names.push_back(filename);
+  return true;
+}
+
+inline int MMOutputMerger::GetNFiles() const {
+  return int(m_files.size());
+}
+
+inline int MMOutputMerger::MergeHistograms(TFile* fout, const string& dirname){
+  // keep insertion order so the output layout follows the first file
+  vector<string> names;
+  map<string, TH1*> sums;
+
+  for(auto f: m_files){
+    TDirectory* dir = f->GetDirectory(dirname.c_str());
+    if(!dir)
+      continue;
+    TIter next(dir->GetListOfKeys());
+    TKey* key;
+    while((key = (TKey*) next())){
+      TObject* obj = key->ReadObj();
+      if(!obj->InheritsFrom("TH1")){
+        delete obj;
+        continue;
+      }
+      TH1* hist = (TH1*) obj;
+      string name = hist->GetName();
+      if(sums.count(name) == 0){
+        hist->SetDirectory(0);
+        sums[name] = hist;
+        names.push_back(name);
+      } else {
+        sums[name]->Add(hist);
+        delete hist;
+      }
+    }
+  }
+
+  if(!fout->GetDirectory(dirname.c_str()))
+    fout->mkdir(dirname.c_str());
+  fout->cd(dirname.c_str());
+  for(auto name: names){
+    sums[name]->Write();
+    delete sums[name];
+  }
+  fout->cd();
+
+  return int(names.size());
+}
+
+inline int MMOutputMerger::MergeSketches(TFile* fout, const string& dirname){
+  vector<MMChannelSketch*> sketches;
+  map<string, MMChannelSketch*> by_name;
+
+  for(auto f: m_files){
+    TDirectory* dir = f->GetDirectory(dirname.c_str());
+    if(!dir)
+      continue;
+    // highest cycle of each tree only
+    set<string> seen;
+    TIter next(dir->GetListOfKeys());
+    TKey* key;
+    while((key = (TKey*) next())){
+      if(string(key->GetClassName()) != "TTree" || seen.count(key->GetName()))
+        continue;
+      seen.insert(key->GetName());
+      TTree* tree = (TTree*) key->ReadObj();
+      string name = tree->GetName();
+      if(by_name.count(name) == 0){
+        by_name[name] = new MMChannelSketch(name, tree->GetTitle());
+        sketches.push_back(by_name[name]);
+      }
+      by_name[name]->Read(tree);
+      delete tree;
+    }
+  }
+
+  if(!fout->GetDirectory(dirname.c_str()))
+    fout->mkdir(dirname.c_str());
+  fout->cd(dirname.c_str());
+  for(auto sketch: sketches){
+    sketch->Write();
+    delete sketch;
+  }
+  fout->cd();
+
+  return int(sketches.size());
+}
+
+inline int MMOutputMerger::MergeAlignment(TFile* fout, const string& dirname){
+  MMAlignment align;
+  int Nread = 0;
+  for(auto f: m_files)
+    if(align.Read(f->GetDirectory(dirname.c_str())))
+      Nread++;
+
+  if(!fout->GetDirectory(dirname.c_str()))
+    fout->mkdir(dirname.c_str());
+  fout->cd(dirname.c_str());
+  align.Save();
+  fout->cd();
+
+  return Nread;
+}
+
+// first all-digit field of a display name, e.g. hits2D_00042_pm2 -> 42
+inline int MMOutputMerger::EventNumber(const string& name){
+  size_t start = 0;
+  while(start <= name.size()){
+    size_t end = name.find('_', start);
+    if(end == string::npos)
+      end = name.size();
+    string field = name.substr(start, end-start);
+    if(!field.empty() && field.find_first_not_of("0123456789") == string::npos)
+      return atoi(field.c_str());
+    start = end+1;
+  }
+  return -1;
+}
+
+inline int MMOutputMerger::MergeEventDisplays(TFile* fout, const string& dirname,
+                                              const string& capped_suffix, int max_capped){
+  // (event number, file, name) of every display, files already in entry order
+  vector<pair<int, pair<int,string> > > displays;
+  int Nfile = GetNFiles();
+  for(int f = 0; f < Nfile; f++){
+    TDirectory* dir = m_files[f]->GetDirectory(dirname.c_str());
+    if(!dir)
+      continue;
+    TIter next(dir->GetListOfKeys());
+    TKey* key;
+    while((key = (TKey*) next())){
+      string name = key->GetName();
+      displays.push_back(make_pair(EventNumber(name), make_pair(f, name)));
+    }
+  }
+  stable_sort(displays.begin(), displays.end(),
+              [](const pair<int, pair<int,string> >& a, const pair<int, pair<int,string> >& b){
+                return a.first < b.first;
+              });
+
+  if(!fout->GetDirectory(dirname.c_str()))
+    fout->mkdir(dirname.c_str());
+
+  int Ncapped = 0;
+  int Nwrite = 0;
+  for(auto& d: displays){
+    const string& name = d.second.second;
+    bool capped = name.size() >= capped_suffix.size() &&
+      name.compare(name.size()-capped_suffix.size(), capped_suffix.size(), capped_suffix) == 0;
+    if(capped){
+      if(Ncapped >= max_capped)
+        continue;
+      Ncapped++;
+    }
+    TObject* obj = m_files[d.second.first]->GetDirectory(dirname.c_str())->Get(name.c_str());
+    if(!obj)
+      continue;
+    fout->cd(dirname.c_str());
+    obj->Write();
+    delete obj;
+    Nwrite++;
+  }
+  fout->cd();
+
+  return Nwrite;
+}
+
+inline bool MMOutputMerger::GetShardInfo(TFile* f, int& run, Long64_t& first,
+                                         Long64_t& last, Long64_t& N) const {
+  TTree* info = (TTree*) f->Get("analysis_info");
+  if(!info || info->GetEntries() < 1)
+    return false;
+  info->SetBranchAddress("runNumber",  &run);
+  info->SetBranchAddress("firstEntry", &first);
+  info->SetBranchAddress("lastEntry",  &last);
+  info->SetBranchAddress("nEntries",   &N);
+  info->GetEntry(0);
+  info->ResetBranchAddresses();
+  return true;
+}
+
+inline bool MMOutputMerger::SortShards(){
+  int Nfile = GetNFiles();
+  vector<Long64_t> firsts(Nfile);
+  vector<Long64_t> lasts(Nfile);
+  vector<int> order(Nfile);
+  int run0 = -1;
+  Long64_t N0 = -1;
+  for(int f = 0; f < Nfile; f++){
+    int run;
+    Long64_t N;
+    if(!GetShardInfo(m_files[f], run, firsts[f], lasts[f], N)){
+      cout << "MMOutputMerger ERROR: no analysis_info in " << m_names[f] << endl;
+      return false;
+    }
+    if(f == 0){
+      run0 = run;
+      N0 = N;
+    } else if(run != run0 || N != N0){
+      cout << "MMOutputMerger ERROR: " << m_names[f] << " is not a shard of run " << run0 << endl;
+      return false;
+    }
+    order[f] = f;
+  }
+  sort(order.begin(), order.end(), [&](int a, int b){ return firsts[a] < firsts[b]; });
+
+  vector<TFile*> files;
+  vector<string> names;
+  Long64_t next = 0;
+  for(int f: order){
+    if(firsts[f] != next)
+      cout << "MMOutputMerger WARNING: entries " << next << " - " << firsts[f]-1
+           << " not covered by any shard" << endl;
+    next = lasts[f];
+    files.push_back(m_files[f]);
+    names.push_back(m_names[f]);
+  }
+  if(next != N0)
+    cout << "MMOutputMerger WARNING: entries " << next << " - " << N0-1
+         << " not covered by any shard" << endl;
+  m_files = files;
+  m_names = names;
+
+  return true;
+}
+
+inline bool MMOutputMerger::MergeShards(TFile* fout){
+  if(GetNFiles() == 0 || !SortShards())
+    return false;
+
+  int run;
+  Long64_t first, last, N, dummy;
+  GetShardInfo(m_files.front(), run, first, dummy, N);
+  GetShardInfo(m_files.back(), run, dummy, last, N);
+
+  fout->cd();
+  TTree* info = new TTree("analysis_info", "analysis_info");
+  info->Branch("runNumber",  &run,   "runNumber/I");
+  info->Branch("firstEntry", &first, "firstEntry/L");
+  info->Branch("lastEntry",  &last,  "lastEntry/L");
+  info->Branch("nEntries",   &N,     "nEntries/L");
+  info->Fill();
+
+  // same directory layout and order as the event loop output
+  TIter next(m_files.front()->GetListOfKeys());
+  TKey* key;
+  while((key = (TKey*) next())){
+    string name = key->GetName();
+    if(string(key->GetClassName()) != "TDirectoryFile")
+      continue;
+    if(name == "event_displays")
+      MergeEventDisplays(fout, name);
+    else if(name == "sketches")
+      MergeSketches(fout, name);
+    else if(name == "alignment")
+      MergeAlignment(fout, name);
+    else
+      MergeHistograms(fout, name);
+  }
+
+  fout->cd();
+  info->Write();
+
+  return true;
+}
+
+#endif
@@ -22,7 +22,8 @@ public:
   
   ~MMPacmanAlgo() {}
 
-  MMClusterList Cluster(const MMFE8Hits& hits);
+  using MMClusterAlgo::Cluster;
+  MMClusterList Cluster(const MMFE8Hits& hits, const vector<char>& good);
 
   void SetClusterSize(int clus_size);
   void SetSeedThreshold(double thresh);
@@ -48,13 +49,13 @@ inline MMPacmanAlgo::MMPacmanAlgo(int clus_size,
   m_good_hits = 0;
 }
 
-inline MMClusterList MMPacmanAlgo::Cluster(const MMFE8Hits& hits){
+inline MMClusterList MMPacmanAlgo::Cluster(const MMFE8Hits& hits, const vector<char>& good){
   MMClusterList cluster_list;
   m_good_hits = 0;
   // forward step
   int Nhit = hits.GetNHits();
   for(int i = 0; i < Nhit; i++){
-    if(!IsGoodHit(hits[i]))
+    if(!good[i])
       continue;
     if(hits[i].Channel() == 63)
       continue;
@@ -66,7 +67,7 @@ inline MMClusterList MMPacmanAlgo::Cluster(const MMFE8Hits& hits){
       int last_channel = hits[i].Channel();
       // look for additional hits forward
       for(int j = i+1; j < Nhit; j++){
-	if(!IsGoodHit(hits[j])){
+	if(!good[j]){
 	  continue;
 	}
 	if(hits[j].Channel() <= last_channel+m_clus_size){
@@ -91,7 +92,7 @@ inline MMClusterList MMPacmanAlgo::Cluster(const MMFE8Hits& hits){
     int i = hits.GetIndex(cluster_list[c][0]);
     int first_channel = cluster_list[c][0].Channel();
     for(int j = i-1; j >= 0; j--){
-      if(!IsGoodHit(hits[j]))
+      if(!good[j])
 	continue;
       if(cluster_list.Contains(hits[j]))
 	break; // already in another cluster
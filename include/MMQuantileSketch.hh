@@ -0,0 +1,288 @@
+///
+///  \file   MMQuantileSketch.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMQuantileSketch_HH
+#define MMQuantileSketch_HH
+
+#include <vector>
+#include <algorithm>
+#include <cmath>
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMQuantileSketch class
+//
+// Streaming quantile and moment estimate of
+// one quantity (merging t-digest): values are
+// buffered and periodically merged into a
+// sorted list of weighted centroids, whose
+// size is bounded by the compression. Exact
+// count, mean, RMS, min and max are kept on
+// the side. Two sketches merge into one as
+// if all values had been added to a single
+// sketch (up to the digest approximation)
+///////////////////////////////////////////////
+
+class MMQuantileSketch {
+
+public:
+  MMQuantileSketch(double compression = 50.);
+  ~MMQuantileSketch() {}
+
+  void Add(double x);
+  void Merge(const MMQuantileSketch& other);
+
+  // merges a stored state (centroids + exact moments)
+  void AddCentroids(const vector<double>& mean, const vector<double>& weight,
+                    double min, double max, double sum, double sum2);
+
+  double GetN() const;
+  double Mean() const;
+  double RMS() const;
+  double Sum() const;
+  double Sum2() const;
+  double Min() const;
+  double Max() const;
+
+  // q in [0, 1]; flushes the buffer first
+  double Quantile(double q);
+
+  // merged centroids, after Compress()
+  void Compress();
+  int GetNCentroids() const;
+  double CentroidMean(int i) const;
+  double CentroidWeight(int i) const;
+
+private:
+  double m_compression;
+
+  vector<double> m_mean;
+  vector<double> m_weight;
+  vector<double> m_buffer;
+
+  double m_N;
+  double m_sum;
+  double m_sum2;
+  double m_min;
+  double m_max;
+
+  // merges the centroids, the buffer and (mean, weight) pairs
+  void Compress(vector<pair<double,double> >& extra);
+
+  // highest quantile a centroid starting at q0 may reach
+  double QuantileLimit(double q0) const;
+};
+
+inline MMQuantileSketch::MMQuantileSketch(double compression){
+  m_compression = compression;
+  m_N = 0.;
+  m_sum = 0.;
+  m_sum2 = 0.;
+  m_min = 0.;
+  m_max = 0.;
+}
+
+inline void MMQuantileSketch::Add(double x){
+  if(m_N == 0.){
+    m_min = x;
+    m_max = x;
+  } else {
+    m_min = std::min(m_min, x);
+    m_max = std::max(m_max, x);
+  }
+  m_N    += 1.;
+  m_sum  += x;
+  m_sum2 += x*x;
+
+  m_buffer.push_back(x);
+  if(m_buffer.size() >= 2*m_compression)
+    Compress();
+}
+
+inline void MMQuantileSketch::Merge(const MMQuantileSketch& other){
+  if(other.m_N == 0.)
+    return;
+  vector<pair<double,double> > extra;
+  extra.reserve(other.m_mean.size() + other.m_buffer.size());
+  for(size_t i = 0; i < other.m_mean.size(); i++)
+    extra.push_back(make_pair(other.m_mean[i], other.m_weight[i]));
+  for(double x: other.m_buffer)
+    extra.push_back(make_pair(x, 1.));
+
+  if(m_N == 0.){
+    m_min = other.m_min;
+    m_max = other.m_max;
+  } else {
+    m_min = std::min(m_min, other.m_min);
+    m_max = std::max(m_max, other.m_max);
+  }
+  m_N    += other.m_N;
+  m_sum  += other.m_sum;
+  m_sum2 += other.m_sum2;
+  Compress(extra);
+}
+
+inline void MMQuantileSketch::AddCentroids(const vector<double>& mean, const vector<double>& weight,
+                                           double min, double max, double sum, double sum2){
+  vector<pair<double,double> > extra;
+  double N = 0.;
+  for(size_t i = 0; i < mean.size() && i < weight.size(); i++){
+    extra.push_back(make_pair(mean[i], weight[i]));
+    N += weight[i];
+  }
+  if(N == 0.)
+    return;
+
+  if(m_N == 0.){
+    m_min = min;
+    m_max = max;
+  } else {
+    m_min = std::min(m_min, min);
+    m_max = std::max(m_max, max);
+  }
+  m_N    += N;
+  m_sum  += sum;
+  m_sum2 += sum2;
+  Compress(extra);
+}
+
+inline void MMQuantileSketch::Compress(){
+  if(m_buffer.empty())
+    return;
+  vector<pair<double,double> > extra;
+  Compress(extra);
+}
+
+inline void MMQuantileSketch::Compress(vector<pair<double,double> >& extra){
+  for(size_t i = 0; i < m_mean.size(); i++)
+    extra.push_back(make_pair(m_mean[i], m_weight[i]));
+  for(double x: m_buffer)
+    extra.push_back(make_pair(x, 1.));
+  m_buffer.clear();
+  m_mean.clear();
+  m_weight.clear();
+  if(extra.empty())
+    return;
+
+  sort(extra.begin(), extra.end());
+
+  // arcsine scale: a centroid starting at quantile q0 may
+  // extend up to the quantile one unit of k(q) further on,
+  // k(q) = compression (asin(2q-1) + pi/2) / pi, so that
+  // centroids are small at the tails (single values are
+  // kept there), wide around the median and at most about
+  // compression of them are kept
+  double total = 0.;
+  for(auto& c: extra)
+    total += c.second;
+
+  double cur_mean   = extra[0].first;
+  double cur_weight = extra[0].second;
+  double below = 0.;
+  double limit = total*QuantileLimit(0.);
+  int Nextra = extra.size();
+  for(int i = 1; i < Nextra; i++){
+    double w = cur_weight + extra[i].second;
+    if(below + w <= limit){
+      cur_mean  += (extra[i].first - cur_mean)*extra[i].second/w;
+      cur_weight = w;
+    } else {
+      m_mean.push_back(cur_mean);
+      m_weight.push_back(cur_weight);
+      below += cur_weight;
+      limit = total*QuantileLimit(below/total);
+      cur_mean   = extra[i].first;
+      cur_weight = extra[i].second;
+    }
+  }
+  m_mean.push_back(cur_mean);
+  m_weight.push_back(cur_weight);
+}
+
+inline double MMQuantileSketch::QuantileLimit(double q0) const {
+  double k = m_compression*(asin(2.*q0 - 1.) + M_PI/2.)/M_PI + 1.;
+  if(k >= m_compression)
+    return 1.;
+  return (sin(k*M_PI/m_compression - M_PI/2.) + 1.)/2.;
+}
+
+inline double MMQuantileSketch::GetN() const {
+  return m_N;
+}
+
+inline double MMQuantileSketch::Mean() const {
+  if(m_N == 0.)
+    return 0.;
+  return m_sum/m_N;
+}
+
+inline double MMQuantileSketch::RMS() const {
+  if(m_N == 0.)
+    return 0.;
+  double mean = m_sum/m_N;
+  return sqrt(std::max(0., m_sum2/m_N - mean*mean));
+}
+
+inline double MMQuantileSketch::Sum() const {
+  return m_sum;
+}
+
+inline double MMQuantileSketch::Sum2() const {
+  return m_sum2;
+}
+
+inline double MMQuantileSketch::Min() const {
+  return m_min;
+}
+
+inline double MMQuantileSketch::Max() const {
+  return m_max;
+}
+
+inline double MMQuantileSketch::Quantile(double q){
+  Compress();
+  int Nc = m_mean.size();
+  if(Nc == 0)
+    return 0.;
+  if(Nc == 1)
+    return m_mean[0];
+  q = std::max(0., std::min(1., q));
+
+  // centroid i is taken at its centre of weight; interpolate
+  // linearly between centres, and towards min / max at the ends
+  double target = q*m_N;
+  double center = m_weight[0]/2.;
+  if(target < center)
+    return m_min + (m_mean[0] - m_min)*target/center;
+  for(int i = 0; i < Nc-1; i++){
+    double next = center + (m_weight[i] + m_weight[i+1])/2.;
+    if(target < next)
+      return m_mean[i] + (m_mean[i+1] - m_mean[i])*(target - center)/(next - center);
+    center = next;
+  }
+  double tail = m_N - center;
+  if(tail <= 0.)
+    return m_max;
+  return m_mean[Nc-1] + (m_max - m_mean[Nc-1])*(target - center)/tail;
+}
+
+inline int MMQuantileSketch::GetNCentroids() const {
+  return int(m_mean.size());
+}
+
+inline double MMQuantileSketch::CentroidMean(int i) const {
+  return m_mean[i];
+}
+
+inline double MMQuantileSketch::CentroidWeight(int i) const {
+  return m_weight[i];
+}
+
+#endif
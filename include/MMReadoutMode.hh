@@ -0,0 +1,64 @@
+///
+///  \file   MMReadoutMode.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMReadoutMode_HH
+#define MMReadoutMode_HH
+
+#include <string>
+
+///////////////////////////////////////////////
+// Readout-mode policies
+//
+// The decoding (MMDataAnalysis) is templated
+// on one of these, so that both modes are in
+// the binary and the per-hit loop carries no
+// mode branch; the mode is picked once per
+// run (conditions key readout, or --readout).
+// Only the hit BCID differs between modes:
+// the drift time (MMHit, MMHitCache) does not
+///////////////////////////////////////////////
+
+enum MMReadout { kReadoutNonL0 = 0, kReadoutL0 = 1 };
+
+// non-L0: BCIDs from the gray-decoded counter
+struct MMReadoutNonL0 {
+  static const MMReadout mode = kReadoutNonL0;
+  static const char* Name() { return "non-L0"; }
+
+  template <class TREE>
+  static int BCID(const TREE& data, int i, int j){
+    return data.grayDecoded->at(i).at(j);
+  }
+};
+
+// L0: BCID of the L0 accept plus the relative BCID
+struct MMReadoutL0 {
+  static const MMReadout mode = kReadoutL0;
+  static const char* Name() { return "L0"; }
+
+  template <class TREE>
+  static int BCID(const TREE& data, int i, int j){
+    return data.bcid->at(i).at(j) + data.relbcid->at(i).at(j);
+  }
+};
+
+// "l0" / "nonl0", -1 if neither
+inline int ParseReadout(const std::string& name){
+  if(name == "l0" || name == "L0")
+    return kReadoutL0;
+  if(name == "nonl0" || name == "non-L0")
+    return kReadoutNonL0;
+  return -1;
+}
+
+inline const char* ReadoutName(int readout){
+  return readout == kReadoutL0 ? MMReadoutL0::Name() : MMReadoutNonL0::Name();
+}
+
+#endif
@@ -0,0 +1,179 @@
+///
+///  \file   MMResidentRun.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMResidentRun_HH
+#define MMResidentRun_HH
+
+#include <iostream>
+#include <vector>
+
+#include "include/MMEventHits.hh"
+#include "include/MMChannelMask.hh"
+#include "include/MMReadoutMode.hh"
+#include "include/TPHit.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMResidentRun class
+//
+// A run held in memory: every entry of a
+// reader (MMDataAnalysis) is decoded and
+// calibrated once by Load() and kept, hits
+// and trigger times, so that the analysis
+// can be re-run on it with other cuts
+// without touching the input again. Same
+// interface as the readers; the readout mode
+// and channel mask are the ones of the
+// reader at Load()
+///////////////////////////////////////////////
+
+class MMResidentRun {
+
+public:
+  MMResidentRun();
+  ~MMResidentRun();
+
+  // all entries of DATA, calibrated (PDOToCharge, TDOToTime)
+  template <class DATA_T, class PDO_T, class TDO_T>
+  Long64_t Load(DATA_T* DATA, const PDO_T* PDOCalibrator, const TDO_T* TDOCalibrator);
+  void Clear();
+
+  int RunNumber() const;
+  bool IsCalibrated() const;
+
+  Int_t GetNEntries();
+  Int_t GetEntry(Long64_t entry);
+  Int_t GetTP();
+  void  SetTP(Int_t doTP);
+
+  void SetReadout(int readout);
+  int  GetReadout() const;
+
+  // the mask is applied when the events are loaded
+  int FindNoisyChannels(Long64_t first, Long64_t Nsample,
+                        double hot_factor = 10., double dead_factor = 0.05);
+
+  Long64_t GetNHits() const;
+
+  MMEventHits mm_EventHits;
+  std::vector<TPHit> mm_ARTHits;
+  MMChannelMask mm_ChannelMask;
+
+private:
+  int m_run;
+  int m_doTP;
+  int m_readout;
+  bool m_calibrated;
+  Long64_t m_Nhit;
+
+  vector<MMEventHits*> m_events;
+  vector<vector<TPHit> > m_art;
+};
+
+inline MMResidentRun::MMResidentRun(){
+  m_run = -1;
+  m_doTP = 1;
+  m_readout = kReadoutNonL0;
+  m_calibrated = false;
+  m_Nhit = 0;
+}
+
+inline MMResidentRun::~MMResidentRun(){
+  Clear();
+}
+
+inline void MMResidentRun::Clear(){
+  for(MMEventHits* evt: m_events)
+    delete evt;
+  m_events.clear();
+  m_art.clear();
+  m_Nhit = 0;
+  m_calibrated = false;
+}
+
+template <class DATA_T, class PDO_T, class TDO_T>
+inline Long64_t MMResidentRun::Load(DATA_T* DATA, const PDO_T* PDOCalibrator, const TDO_T* TDOCalibrator){
+  Clear();
+  m_run = DATA->RunNumber();
+  m_doTP = DATA->GetTP();
+  m_readout = DATA->GetReadout();
+  mm_ChannelMask = DATA->mm_ChannelMask;
+
+  Long64_t Nentry = DATA->GetNEntries();
+  m_events.reserve(Nentry);
+  m_art.reserve(Nentry);
+  for(Long64_t entry = 0; entry < Nentry; entry++){
+    DATA->GetEntry(entry);
+    PDOCalibrator->Calibrate(DATA->mm_EventHits);
+    TDOCalibrator->Calibrate(DATA->mm_EventHits);
+
+    MMEventHits* evt = new MMEventHits(DATA->mm_EventHits);
+    evt->CopyTrigTime(DATA->mm_EventHits);
+    for(int i = 0; i < evt->GetNBoards(); i++)
+      m_Nhit += (*evt)[i].GetNHits();
+    m_events.push_back(evt);
+    m_art.push_back(DATA->mm_ARTHits);
+  }
+  m_calibrated = true;
+  return Nentry;
+}
+
+inline int MMResidentRun::RunNumber() const {
+  return m_run;
+}
+
+inline bool MMResidentRun::IsCalibrated() const {
+  return m_calibrated;
+}
+
+inline Int_t MMResidentRun::GetNEntries(){
+  return int(m_events.size());
+}
+
+inline Int_t MMResidentRun::GetEntry(Long64_t entry){
+  if(entry < 0 || entry >= Long64_t(m_events.size()))
+    return false;
+  mm_EventHits = *m_events[entry];
+  mm_EventHits.CopyTrigTime(*m_events[entry]);
+  if(m_doTP)
+    mm_ARTHits = m_art[entry];
+  else
+    mm_ARTHits.clear();
+  return true;
+}
+
+inline Int_t MMResidentRun::GetTP(){
+  return m_doTP;
+}
+
+inline void MMResidentRun::SetTP(int doTP){
+  m_doTP = doTP;
+}
+
+inline void MMResidentRun::SetReadout(int readout){
+  if(readout != m_readout)
+    cout << "MMResidentRun WARNING: events were decoded with " << ReadoutName(m_readout)
+         << " readout, ignoring " << ReadoutName(readout) << endl;
+}
+
+inline int MMResidentRun::GetReadout() const {
+  return m_readout;
+}
+
+inline int MMResidentRun::FindNoisyChannels(Long64_t, Long64_t, double, double){
+  cout << "MMResidentRun WARNING: the channel mask is fixed when the run is loaded" << endl;
+  return 0;
+}
+
+inline Long64_t MMResidentRun::GetNHits() const {
+  return m_Nhit;
+}
+
+#endif
@@ -55,8 +55,6 @@ public :
    virtual void     Show(Long64_t entry = -1);
 };
 
-#endif
-
 inline MMRunProperties::MMRunProperties(TTree *tree) : fChain(0) 
 {
 // if parameter tree is not specified (or zero), connect the file
@@ -78,7 +76,7 @@ inline MMRunProperties::~MMRunProperties()
    delete fChain->GetCurrentFile();
 }
 
-Int_t MMRunProperties::GetEntry(Long64_t entry)
+inline Int_t MMRunProperties::GetEntry(Long64_t entry)
 {
 // Read contents of entry.
    if (!fChain) return 0;
@@ -153,3 +151,5 @@ inline Int_t MMRunProperties::Cut(Long64_t entry)
 // returns -1 otherwise.
    return 1;
 }
+
+#endif
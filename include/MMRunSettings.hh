@@ -0,0 +1,244 @@
+///
+///  \file   MMRunSettings.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMRunSettings_HH
+#define MMRunSettings_HH
+
+#include <cmath>
+
+#include "include/MMReadoutMode.hh"
+#include "include/MMBoardMap.hh"
+
+///////////////////////////////////////////////
+// MMRunSettings class
+//
+// Per-run analysis state (readout mode,
+// alignment offset, trigger BCID windows,
+// transition skipping, PACMAN BCID window,
+// plane geometry) resolved once per run by
+// MMConditions, so that several runs can be
+// analyzed side by side without sharing
+// globals
+///////////////////////////////////////////////
+
+class MMRunSettings {
+
+public:
+  MMRunSettings(int RunNumber = -1);
+  ~MMRunSettings() {}
+
+  int RunNumber() const;
+
+  // kReadoutNonL0 or kReadoutL0 (MMReadoutMode.hh)
+  int Readout() const;
+
+  // skip events where dBCIDrel changes w.r.t. previous event
+  bool SkipTransition() const;
+
+  // board 0 - board 1 alignment offset [mm]
+  double Offset() const;
+  // position-dependent part (rotation / pitch): offset
+  // + OffsetSlope() x x_bary of board 1
+  double OffsetSlope() const;
+
+  // strip - trigger BCID window passed to the clustering
+  int MinBCIDDiff() const;
+  int MaxBCIDDiff() const;
+  bool UseBCIDDiff() const;
+
+  // board 2 - board 3 trigger BCID windows
+  bool PassTrigBCID(int dBCID) const;
+  bool PassTrigBCIDrel(int dBCIDrel) const;
+
+  // plane z [mm] and stereo angle [rad] by layer index,
+  // 0 for an X plane (track finding, MMHoughTracker)
+  double PlaneZ(int layer) const;
+  double PlaneStereo(int layer) const;
+
+  void SetRunNumber(int RunNumber);
+  void SetReadout(int readout);
+  void SetSkipTransition(bool skip);
+  void SetOffset(double offset);
+  void SetOffsetSlope(double slope);
+  void SetBCIDDiff(int min_diff, int max_diff);
+  void SetTrigBCIDWindow(int min_dBCID, int max_dBCID);
+  void SetTrigBCIDrelWindow(int min_dBCIDrel, int max_dBCIDrel);
+  void SetUseBCIDDiff(bool use);
+  void SetUseTrigBCIDWindow(bool use);
+  void SetUseTrigBCIDrelWindow(bool use);
+  void SetPlaneZ(int layer, double z);
+  void SetPlaneStereo(int layer, double stereo);
+
+private:
+  int m_RunNumber;
+  int m_readout;
+  bool m_skip_transition;
+  double m_offset;
+  double m_offset_slope;
+
+  bool m_use_BCID_diff;
+  int m_min_BCID_diff;
+  int m_max_BCID_diff;
+
+  bool m_use_trig_window;
+  int m_min_dBCID;
+  int m_max_dBCID;
+  bool m_use_trig_rel_window;
+  int m_min_dBCIDrel;
+  int m_max_dBCIDrel;
+
+  double m_plane_z[MMBoardMap::NBOARD];
+  double m_plane_stereo[MMBoardMap::NBOARD];
+};
+
+inline MMRunSettings::MMRunSettings(int RunNumber){
+  m_RunNumber = RunNumber;
+  m_readout = kReadoutNonL0;
+
+  m_skip_transition = true;
+  m_offset = -1.2;
+  m_offset_slope = 0.;
+
+  m_use_BCID_diff = true;
+  m_min_BCID_diff = -2;
+  m_max_BCID_diff = 7;
+
+  m_use_trig_window = false;
+  m_min_dBCID = 0;
+  m_max_dBCID = 0;
+  m_use_trig_rel_window = false;
+  m_min_dBCIDrel = 0;
+  m_max_dBCIDrel = 0;
+
+  // octuplet X X U V U V X X
+  const double z[MMBoardMap::NBOARD] = {0., 11.2, 32.4, 43.6, 113.6, 124.8, 146.0, 157.2};
+  const double stereo[MMBoardMap::NBOARD] = {0., 0., 1.5, -1.5, 1.5, -1.5, 0., 0.};
+  for (int l = 0; l < MMBoardMap::NBOARD; l++){
+    m_plane_z[l] = z[l];
+    m_plane_stereo[l] = stereo[l]*M_PI/180.;
+  }
+}
+
+inline int MMRunSettings::RunNumber() const {
+  return m_RunNumber;
+}
+
+inline void MMRunSettings::SetRunNumber(int RunNumber){
+  m_RunNumber = RunNumber;
+}
+
+inline int MMRunSettings::Readout() const {
+  return m_readout;
+}
+
+inline bool MMRunSettings::SkipTransition() const {
+  return m_skip_transition;
+}
+
+inline double MMRunSettings::Offset() const {
+  return m_offset;
+}
+
+inline double MMRunSettings::OffsetSlope() const {
+  return m_offset_slope;
+}
+
+inline int MMRunSettings::MinBCIDDiff() const {
+  return m_min_BCID_diff;
+}
+
+inline int MMRunSettings::MaxBCIDDiff() const {
+  return m_max_BCID_diff;
+}
+
+inline bool MMRunSettings::UseBCIDDiff() const {
+  return m_use_BCID_diff;
+}
+
+inline bool MMRunSettings::PassTrigBCID(int dBCID) const {
+  if (!m_use_trig_window)
+    return true;
+  return dBCID >= m_min_dBCID && dBCID <= m_max_dBCID;
+}
+
+inline bool MMRunSettings::PassTrigBCIDrel(int dBCIDrel) const {
+  if (!m_use_trig_rel_window)
+    return true;
+  return dBCIDrel >= m_min_dBCIDrel && dBCIDrel <= m_max_dBCIDrel;
+}
+
+inline double MMRunSettings::PlaneZ(int layer) const {
+  if (layer < 0 || layer >= MMBoardMap::NBOARD)
+    return 0.;
+  return m_plane_z[layer];
+}
+
+inline double MMRunSettings::PlaneStereo(int layer) const {
+  if (layer < 0 || layer >= MMBoardMap::NBOARD)
+    return 0.;
+  return m_plane_stereo[layer];
+}
+
+inline void MMRunSettings::SetReadout(int readout){
+  m_readout = readout;
+}
+
+inline void MMRunSettings::SetSkipTransition(bool skip){
+  m_skip_transition = skip;
+}
+
+inline void MMRunSettings::SetOffset(double offset){
+  m_offset = offset;
+}
+
+inline void MMRunSettings::SetOffsetSlope(double slope){
+  m_offset_slope = slope;
+}
+
+inline void MMRunSettings::SetBCIDDiff(int min_diff, int max_diff){
+  m_use_BCID_diff = true;
+  m_min_BCID_diff = min_diff;
+  m_max_BCID_diff = max_diff;
+}
+
+inline void MMRunSettings::SetTrigBCIDWindow(int min_dBCID, int max_dBCID){
+  m_use_trig_window = true;
+  m_min_dBCID = min_dBCID;
+  m_max_dBCID = max_dBCID;
+}
+
+inline void MMRunSettings::SetTrigBCIDrelWindow(int min_dBCIDrel, int max_dBCIDrel){
+  m_use_trig_rel_window = true;
+  m_min_dBCIDrel = min_dBCIDrel;
+  m_max_dBCIDrel = max_dBCIDrel;
+}
+
+inline void MMRunSettings::SetUseBCIDDiff(bool use){
+  m_use_BCID_diff = use;
+}
+
+inline void MMRunSettings::SetUseTrigBCIDWindow(bool use){
+  m_use_trig_window = use;
+}
+
+inline void MMRunSettings::SetUseTrigBCIDrelWindow(bool use){
+  m_use_trig_rel_window = use;
+}
+
+inline void MMRunSettings::SetPlaneZ(int layer, double z){
+  if (layer >= 0 && layer < MMBoardMap::NBOARD)
+    m_plane_z[layer] = z;
+}
+
+inline void MMRunSettings::SetPlaneStereo(int layer, double stereo){
+  if (layer >= 0 && layer < MMBoardMap::NBOARD)
+    m_plane_stereo[layer] = stereo;
+}
+
+#endif
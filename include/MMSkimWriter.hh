@@ -0,0 +1,134 @@
+///
+///  \file   MMSkimWriter.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMSkimWriter_HH
+#define MMSkimWriter_HH
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <TFile.h>
+#include <TTree.h>
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMSkimWriter class
+//
+// Selected entries of a run, written as a
+// file with the vmm and run_properties trees
+// of the input, so that MMDataAnalysis and
+// MMRunProperties read it like the original.
+// The input is opened again: the trees of
+// the event loop stay untouched. The
+// run_properties tree is cloned whole from
+// its raw baskets ("fast"); a basket of vmm
+// holds many entries, so a subset is read
+// (in increasing entry order, through the
+// tree cache) and filled again, and only a
+// complete selection is fast-cloned. The
+// source entries go to skim_entries
+///////////////////////////////////////////////
+
+class MMSkimWriter {
+
+public:
+  MMSkimWriter(const string& filename = "");
+  ~MMSkimWriter() {}
+
+  bool IsEnabled() const;
+  const string& GetFileName() const;
+
+  // entries of the input tree, increasing
+  void Add(Long64_t entry);
+  Long64_t GetNSelected() const;
+
+  // returns the number of vmm entries written, -1 on error
+  Long64_t Write(const string& input) const;
+
+private:
+  string m_filename;
+  vector<Long64_t> m_entries;
+};
+
+inline MMSkimWriter::MMSkimWriter(const string& filename){
+  m_filename = filename;
+}
+
+inline bool MMSkimWriter::IsEnabled() const {
+  return !m_filename.empty();
+}
+
+inline const string& MMSkimWriter::GetFileName() const {
+  return m_filename;
+}
+
+inline void MMSkimWriter::Add(Long64_t entry){
+  if(!m_entries.empty() && entry <= m_entries.back())
+    return;
+  m_entries.push_back(entry);
+}
+
+inline Long64_t MMSkimWriter::GetNSelected() const {
+  return m_entries.size();
+}
+
+inline Long64_t MMSkimWriter::Write(const string& input) const {
+  TFile* fin = new TFile(input.c_str(), "READ");
+  if(!fin || fin->IsZombie()){
+    cout << "MMSkimWriter ERROR: cannot open " << input << endl;
+    return -1;
+  }
+  TTree* vmm = (TTree*) fin->Get("vmm");
+  TTree* run_properties = (TTree*) fin->Get("run_properties");
+  if(!vmm || !run_properties){
+    cout << "MMSkimWriter ERROR: no vmm or run_properties tree in " << input << endl;
+    fin->Close();
+    return -1;
+  }
+
+  TFile* fout = new TFile(m_filename.c_str(), "RECREATE");
+  if(!fout || fout->IsZombie()){
+    cout << "MMSkimWriter ERROR: cannot create " << m_filename << endl;
+    fin->Close();
+    return -1;
+  }
+  fout->cd();
+  TTree* run_out = run_properties->CloneTree(-1, "fast");
+  TTree* vmm_out = vmm->CloneTree(0);
+  if(Long64_t(m_entries.size()) == vmm->GetEntries()){
+    vmm_out->CopyEntries(vmm, -1, "fast");
+  } else {
+    vmm->SetCacheSize(64*1024*1024);
+    vmm->AddBranchToCache("*", true);
+    for(Long64_t entry: m_entries){
+      vmm->GetEntry(entry);
+      vmm_out->Fill();
+    }
+  }
+
+  Long64_t sourceEntry;
+  TTree* info = new TTree("skim_entries", "skim_entries");
+  info->Branch("sourceEntry", &sourceEntry, "sourceEntry/L");
+  for(Long64_t entry: m_entries){
+    sourceEntry = entry;
+    info->Fill();
+  }
+
+  Long64_t Nwritten = vmm_out->GetEntries();
+  vmm_out->Write();
+  run_out->Write();
+  info->Write();
+  fout->Close();
+  fin->Close();
+  return Nwritten;
+}
+
+#endif
@@ -0,0 +1,346 @@
+///
+///  \file   MMSliceFitter.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMSliceFitter_HH
+#define MMSliceFitter_HH
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <thread>
+#include <atomic>
+#include <cmath>
+
+#include <TROOT.h>
+#include <TFile.h>
+#include <TH1D.h>
+#include <TH2D.h>
+#include <TF1.h>
+#include <TGraphErrors.h>
+#include <Math/MinimizerOptions.h>
+
+#include "include/MMChannelSketch.hh"
+
+using namespace std;
+
+enum MMFitModel { kFitGaus = 0, kFitGaus2 = 1, kFitLandau = 2 };
+
+///////////////////////////////////////////////
+// MMSliceFitter class
+//
+// Post-processing fits of the output
+// histograms: 1D histograms, and the Y
+// projections of groups of X bins of 2D
+// histograms (x slices, strips). Histograms
+// and functions are prepared in the calling
+// thread; the fits then run on a pool of
+// threads (Minuit2, thread-safe ROOT) and the
+// results of each series are written as
+// TGraphErrors of mean and sigma (Landau: MPV
+// and width) versus the slice centre
+///////////////////////////////////////////////
+
+class MMSliceFitter {
+
+public:
+  // Nthread = 0: one per core
+  MMSliceFitter(int Nthread = 0, double min_entries = 50.);
+  ~MMSliceFitter();
+
+  void Add(const string& name, const TH1* hist, int model);
+  void AddSlices(const string& name, const TH2* hist, int model, int Ngroup = 1);
+  // one fit per strip of a board of an MMChannelSketch, on
+  // a histogram rebuilt from Nq equally spaced quantiles
+  void AddSketch(const string& name, MMChannelSketch& sketch, int board, int model,
+                 int Nbin, double xmin, double xmax, int Nq = 500);
+
+  // returns the number of converged fits
+  int Fit();
+  int GetNFits() const;
+
+  // two graphs per series, returns how many were written
+  int Write(TDirectory* dir) const;
+
+  // the standard fits of a RunTBAnalysis output file,
+  // written to its fits/ directory
+  static int FitFile(const string& filename, int Nthread = 0);
+
+private:
+  struct SliceFit {
+    TH1D* hist;
+    TF1* func;
+    int model;
+    double x;
+    double ex;
+    bool ok;
+    double mean;
+    double mean_err;
+    double sigma;
+    double sigma_err;
+  };
+  struct Series {
+    string name;
+    string xtitle;
+    int model;
+    vector<int> fits;
+  };
+
+  int m_Nthread;
+  double m_min_entries;
+  vector<SliceFit> m_fits;
+  vector<Series> m_series;
+
+  void AddFit(Series& series, TH1D* hist, double x, double ex, int model);
+  static void FitOne(SliceFit& fit);
+};
+
+inline MMSliceFitter::MMSliceFitter(int Nthread, double min_entries){
+  m_Nthread = Nthread;
+  if(m_Nthread < 1)
+    m_Nthread = std::max(1u, thread::hardware_concurrency());
+  m_min_entries = min_entries;
+}
+
+inline MMSliceFitter::~MMSliceFitter(){
+  for(SliceFit& fit: m_fits){
+    delete fit.hist;
+    delete fit.func;
+  }
+}
+
+inline void MMSliceFitter::AddFit(Series& series, TH1D* hist, double x, double ex, int model){
+  if(hist->GetEntries() < m_min_entries){
+    delete hist;
+    return;
+  }
+  SliceFit fit;
+  fit.hist = hist;
+  fit.model = model;
+  fit.x = x;
+  fit.ex = ex;
+  fit.ok = false;
+  fit.mean = fit.mean_err = fit.sigma = fit.sigma_err = 0.;
+
+  // starting values and range from the peak and the RMS
+  string fname = string(hist->GetName()) + "_fit";
+  double xmin = hist->GetXaxis()->GetXmin();
+  double xmax = hist->GetXaxis()->GetXmax();
+  double peak = hist->GetBinCenter(hist->GetMaximumBin());
+  double height = hist->GetMaximum();
+  double rms = hist->GetRMS();
+  if(rms <= 0.)
+    rms = hist->GetXaxis()->GetBinWidth(1);
+  if(model == kFitLandau){
+    fit.func = new TF1(fname.c_str(), "landau", std::max(xmin, peak - rms/2.), std::min(xmax, peak + 3.*rms));
+    fit.func->SetParameters(height*4., peak, rms/4.);
+  } else if(model == kFitGaus2){
+    // common mean, core [2] and tail [4] widths
+    fit.func = new TF1(fname.c_str(), "[0]*exp(-0.5*((x-[1])/[2])^2) + [3]*exp(-0.5*((x-[1])/[4])^2)",
+                       std::max(xmin, peak - 4.*rms), std::min(xmax, peak + 4.*rms));
+    fit.func->SetParameters(0.8*height, peak, rms/2., 0.2*height, 2.*rms);
+    fit.func->SetParLimits(3, 0., 10.*height);
+  } else {
+    fit.func = new TF1(fname.c_str(), "gaus", std::max(xmin, peak - 2.*rms), std::min(xmax, peak + 2.*rms));
+    fit.func->SetParameters(height, peak, rms);
+  }
+
+  series.fits.push_back(m_fits.size());
+  m_fits.push_back(fit);
+}
+
+inline void MMSliceFitter::Add(const string& name, const TH1* hist, int model){
+  if(!hist)
+    return;
+  Series series;
+  series.name = name;
+  series.xtitle = "";
+  series.model = model;
+  TH1D* copy = (TH1D*) hist->Clone((name + "_all").c_str());
+  copy->SetDirectory(0);
+  AddFit(series, copy, 0., 0., model);
+  m_series.push_back(series);
+}
+
+inline void MMSliceFitter::AddSlices(const string& name, const TH2* hist, int model, int Ngroup){
+  if(!hist)
+    return;
+  if(Ngroup < 1)
+    Ngroup = 1;
+  Series series;
+  series.name = name;
+  series.xtitle = hist->GetXaxis()->GetTitle();
+  series.model = model;
+  int Nbin = hist->GetNbinsX();
+  for(int first = 1; first <= Nbin; first += Ngroup){
+    int last = std::min(Nbin, first + Ngroup - 1);
+    string sname = name + "_slice" + to_string(first);
+    TH1D* slice = hist->ProjectionY(sname.c_str(), first, last);
+    slice->SetDirectory(0);
+    double lo = hist->GetXaxis()->GetBinLowEdge(first);
+    double hi = hist->GetXaxis()->GetBinUpEdge(last);
+    AddFit(series, slice, (lo + hi)/2., (hi - lo)/2., model);
+  }
+  m_series.push_back(series);
+}
+
+inline void MMSliceFitter::AddSketch(const string& name, MMChannelSketch& sketch, int board, int model,
+                                     int Nbin, double xmin, double xmax, int Nq){
+  Series series;
+  series.name = name;
+  series.xtitle = "strip number";
+  series.model = model;
+  for(int strip = 0; strip < MMChannelSketch::NSTRIP; strip++){
+    MMQuantileSketch& quantiles = sketch.Get(board, strip);
+    double N = quantiles.GetN();
+    if(N < m_min_entries)
+      continue;
+    string sname = name + "_strip" + to_string(strip);
+    TH1D* hist = new TH1D(sname.c_str(), "", Nbin, xmin, xmax);
+    hist->SetDirectory(0);
+    for(int k = 0; k < Nq; k++)
+      hist->Fill(quantiles.Quantile((k + 0.5)/Nq));
+    // each quantile stands for N/Nq entries: Poisson
+    // errors of the scaled content, not of the weights
+    hist->Scale(N/Nq);
+    for(int bin = 1; bin <= Nbin; bin++)
+      hist->SetBinError(bin, sqrt(hist->GetBinContent(bin)));
+    hist->SetEntries(N);
+    AddFit(series, hist, strip, 0.5, model);
+  }
+  m_series.push_back(series);
+}
+
+inline void MMSliceFitter::FitOne(SliceFit& fit){
+  int status = fit.hist->Fit(fit.func, "QN0R");
+  fit.ok = (status == 0);
+  if(!fit.ok)
+    return;
+  fit.mean = fit.func->GetParameter(1);
+  fit.mean_err = fit.func->GetParError(1);
+  fit.sigma = fabs(fit.func->GetParameter(2));
+  fit.sigma_err = fit.func->GetParError(2);
+}
+
+inline int MMSliceFitter::Fit(){
+  ROOT::EnableThreadSafety();
+  ROOT::Math::MinimizerOptions::SetDefaultMinimizer("Minuit2");
+
+  // each thread takes the next fit until none are left
+  atomic<int> next(0);
+  int Nfit = m_fits.size();
+  vector<thread> pool;
+  for(int t = 0; t < std::min(m_Nthread, Nfit); t++)
+    pool.push_back(thread([this, &next, Nfit](){
+          for(int i = next++; i < Nfit; i = next++)
+            FitOne(m_fits[i]);
+        }));
+  for(thread& t: pool)
+    t.join();
+
+  int Nok = 0;
+  for(const SliceFit& fit: m_fits)
+    Nok += fit.ok;
+  return Nok;
+}
+
+inline int MMSliceFitter::GetNFits() const {
+  return m_fits.size();
+}
+
+inline int MMSliceFitter::Write(TDirectory* dir) const {
+  int Nwrite = 0;
+  for(const Series& series: m_series){
+    vector<double> x, ex, mean, mean_err, sigma, sigma_err;
+    for(int i: series.fits){
+      const SliceFit& fit = m_fits[i];
+      if(!fit.ok)
+        continue;
+      x.push_back(fit.x);
+      ex.push_back(fit.ex);
+      mean.push_back(fit.mean);
+      mean_err.push_back(fit.mean_err);
+      sigma.push_back(fit.sigma);
+      sigma_err.push_back(fit.sigma_err);
+    }
+    if(x.empty())
+      continue;
+    bool landau = (series.model == kFitLandau);
+    string mean_name  = series.name + (landau ? "_mpv" : "_mean");
+    string sigma_name = series.name + (landau ? "_width" : "_sigma");
+    TGraphErrors* g_mean  = new TGraphErrors(x.size(), &x[0], &mean[0], &ex[0], &mean_err[0]);
+    TGraphErrors* g_sigma = new TGraphErrors(x.size(), &x[0], &sigma[0], &ex[0], &sigma_err[0]);
+    g_mean->SetNameTitle(mean_name.c_str(), (";" + series.xtitle + ";" + (landau ? "MPV" : "mean")).c_str());
+    g_sigma->SetNameTitle(sigma_name.c_str(), (";" + series.xtitle + ";" + (landau ? "width" : "#sigma")).c_str());
+    dir->cd();
+    g_mean->Write(0, TObject::kOverwrite);
+    g_sigma->Write(0, TObject::kOverwrite);
+    delete g_mean;
+    delete g_sigma;
+    Nwrite += 2;
+  }
+  return Nwrite;
+}
+
+inline int MMSliceFitter::FitFile(const string& filename, int Nthread){
+  TFile* f = new TFile(filename.c_str(), "UPDATE");
+  if(!f || f->IsZombie()){
+    cout << "MMSliceFitter ERROR: cannot open " << filename << endl;
+    return -1;
+  }
+  TDirectory* hists = f->GetDirectory("histograms");
+  if(!hists){
+    cout << "MMSliceFitter ERROR: no histograms in " << filename << endl;
+    f->Close();
+    return -1;
+  }
+
+  // per-strip charge: the dense histograms if booked, the
+  // sketches (always filled by the default plan) otherwise
+  MMChannelSketch strip_q("strip_q_vs_ch", "Charge [fC]");
+  TDirectory* sketches = f->GetDirectory("sketches");
+  bool strip_q_sketch = sketches && strip_q.Read((TTree*) sketches->Get("strip_q_vs_ch"));
+  bool strip_q_dense = false;
+
+  MMSliceFitter fitter(Nthread);
+  fitter.Add("track_diff01_bary", (TH1*) hists->Get("track_diff01_bary"), kFitGaus2);
+  fitter.AddSlices("hits_per_clus_max_track_diff01_bary",
+                   (TH2*) hists->Get("hits_per_clus_max_track_diff01_bary"), kFitGaus);
+  for(int ibo = 0; ; ibo++){
+    TH2* x_slices = (TH2*) hists->Get(Form("x_bary_%i_track_diff01_bary", ibo));
+    if(!x_slices)
+      break;
+    // 2 mm slices
+    fitter.AddSlices(Form("x_bary_%i_track_diff01_bary", ibo), x_slices, kFitGaus, 10);
+    fitter.AddSlices(Form("hits_per_clus_%i_track_diff01_bary", ibo),
+                     (TH2*) hists->Get(Form("hits_per_clus_%i_track_diff01_bary", ibo)), kFitGaus);
+    // booked with --dense-strip-hists only
+    TH2* strip_slices = (TH2*) hists->Get(Form("strip_q_vs_ch_%i", ibo));
+    if(strip_slices){
+      fitter.AddSlices(Form("strip_q_vs_ch_%i", ibo), strip_slices, kFitLandau);
+      strip_q_dense = true;
+    } else if(strip_q_sketch){
+      // 1 fC bins over the range of strip_q_vs_ch_%i
+      fitter.AddSketch(Form("strip_q_vs_ch_%i", ibo), strip_q, ibo, kFitLandau, 128, 0., 128.);
+    }
+  }
+  if(!strip_q_dense)
+    cout << "MMSliceFitter: strip charge " << (strip_q_sketch ? "fitted from the strip_q_vs_ch sketches"
+                                                             : "fits skipped, no strip_q_vs_ch histograms or sketches")
+         << " in " << filename << endl;
+
+  int Nok = fitter.Fit();
+  if(!f->GetDirectory("fits"))
+    f->mkdir("fits");
+  fitter.Write(f->GetDirectory("fits"));
+  f->Close();
+  cout << "MMSliceFitter: " << Nok << " of " << fitter.GetNFits() << " fits converged in " << filename << endl;
+  return Nok;
+}
+
+#endif
@@ -0,0 +1,315 @@
+///
+///  \file   MMStageProfile.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMStageProfile_HH
+#define MMStageProfile_HH
+
+#include <iostream>
+#include <iomanip>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <cstring>
+#include <cerrno>
+
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <linux/perf_event.h>
+
+using namespace std;
+
+enum MMPerfEvent { kPerfCycles = 0, kPerfInstructions, kPerfL1DMiss,
+                   kPerfLLCMiss, kPerfBranchMiss, kPerfNEvent };
+
+///////////////////////////////////////////////
+// MMPerfCounters class
+//
+// Hardware counters of this thread (user
+// space only) from perf_event_open: cycles,
+// instructions, L1D read misses, LLC misses
+// and branch misses, read together as one
+// group. Counters the kernel or the container
+// refuses are left out; Open() is false if
+// none could be opened
+///////////////////////////////////////////////
+
+class MMPerfCounters {
+
+public:
+  MMPerfCounters();
+  ~MMPerfCounters();
+
+  bool Open();
+  void Close();
+  bool IsOpen() const;
+  bool Has(int event) const;
+
+  // kPerfNEvent values, 0 for the missing counters
+  bool Read(long long* values) const;
+  // fraction of the time the group was on the PMU
+  double Running() const;
+
+  static const char* Name(int event);
+
+private:
+  int m_leader;
+  int m_fd[kPerfNEvent];
+  int m_slot[kPerfNEvent];  // position in the group read
+  int m_Nopen;
+  mutable double m_running;
+
+  static int OpenEvent(int event, int group_fd);
+};
+
+inline MMPerfCounters::MMPerfCounters(){
+  m_leader = -1;
+  m_Nopen = 0;
+  m_running = 0.;
+  for(int e = 0; e < kPerfNEvent; e++){
+    m_fd[e] = -1;
+    m_slot[e] = -1;
+  }
+}
+
+inline MMPerfCounters::~MMPerfCounters(){
+  Close();
+}
+
+inline const char* MMPerfCounters::Name(int event){
+  switch(event){
+  case kPerfCycles:       return "cycles";
+  case kPerfInstructions: return "instructions";
+  case kPerfL1DMiss:      return "L1D misses";
+  case kPerfLLCMiss:      return "LLC misses";
+  case kPerfBranchMiss:   return "branch misses";
+  }
+  return "";
+}
+
+inline int MMPerfCounters::OpenEvent(int event, int group_fd){
+  struct perf_event_attr attr;
+  memset(&attr, 0, sizeof(attr));
+  attr.size = sizeof(attr);
+  attr.type = PERF_TYPE_HARDWARE;
+  switch(event){
+  case kPerfCycles:       attr.config = PERF_COUNT_HW_CPU_CYCLES;    break;
+  case kPerfInstructions: attr.config = PERF_COUNT_HW_INSTRUCTIONS;  break;
+  case kPerfLLCMiss:      attr.config = PERF_COUNT_HW_CACHE_MISSES;  break;
+  case kPerfBranchMiss:   attr.config = PERF_COUNT_HW_BRANCH_MISSES; break;
+  case kPerfL1DMiss:
+    attr.type = PERF_TYPE_HW_CACHE;
+    attr.config = PERF_COUNT_HW_CACHE_L1D |
+      (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+    break;
+  }
+  attr.disabled = (group_fd < 0);
+  attr.exclude_kernel = 1;
+  attr.exclude_hv = 1;
+  attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+  return syscall(__NR_perf_event_open, &attr, 0, -1, group_fd, 0);
+}
+
+inline bool MMPerfCounters::Open(){
+  Close();
+  int error = 0;
+  for(int e = 0; e < kPerfNEvent; e++){
+    int fd = OpenEvent(e, m_leader);
+    if(fd < 0){
+      error = errno;
+      continue;
+    }
+    if(m_leader < 0)
+      m_leader = fd;
+    m_fd[e] = fd;
+    m_slot[e] = m_Nopen++;
+  }
+  if(m_leader < 0){
+    cout << "MMPerfCounters: hardware counters not available (" << strerror(error)
+         << "), stage timers only" << endl;
+    return false;
+  }
+  if(m_Nopen < kPerfNEvent){
+    cout << "MMPerfCounters: counters not available:";
+    for(int e = 0; e < kPerfNEvent; e++)
+      if(m_fd[e] < 0)
+        cout << " " << Name(e);
+    cout << endl;
+  }
+  ioctl(m_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+  ioctl(m_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+  return true;
+}
+
+inline void MMPerfCounters::Close(){
+  for(int e = 0; e < kPerfNEvent; e++){
+    if(m_fd[e] >= 0)
+      close(m_fd[e]);
+    m_fd[e] = -1;
+    m_slot[e] = -1;
+  }
+  m_leader = -1;
+  m_Nopen = 0;
+}
+
+inline bool MMPerfCounters::IsOpen() const {
+  return m_leader >= 0;
+}
+
+inline bool MMPerfCounters::Has(int event) const {
+  return m_fd[event] >= 0;
+}
+
+inline bool MMPerfCounters::Read(long long* values) const {
+  for(int e = 0; e < kPerfNEvent; e++)
+    values[e] = 0;
+  if(m_leader < 0)
+    return false;
+  // nr, time enabled, time running, values
+  unsigned long long buf[3 + kPerfNEvent];
+  if(read(m_leader, buf, sizeof(buf)) < ssize_t((3 + m_Nopen)*sizeof(unsigned long long)))
+    return false;
+  m_running = (buf[1] > 0) ? double(buf[2])/double(buf[1]) : 0.;
+  for(int e = 0; e < kPerfNEvent; e++)
+    if(m_slot[e] >= 0)
+      values[e] = buf[3 + m_slot[e]];
+  return true;
+}
+
+inline double MMPerfCounters::Running() const {
+  return m_running;
+}
+
+///////////////////////////////////////////////
+// MMStageProfile class
+//
+// Wall time and hardware counters of named
+// stages of the event loop: Start(k) and
+// Stop(k) around each call of stage k add the
+// differences to the stage. Print() reports
+// per event and per hit. Disabled, Start and
+// Stop are one test; without counters only
+// the timers are reported
+///////////////////////////////////////////////
+
+class MMStageProfile {
+
+public:
+  MMStageProfile(bool enable = false, bool counters = true);
+
+  int AddStage(const string& name);
+  void Start(int stage);
+  void Stop(int stage);
+  bool IsEnabled() const;
+
+  void Print(double Nevent, double Nhit) const;
+
+private:
+  struct Stage {
+    string name;
+    long long calls;
+    double ns;
+    long long count[kPerfNEvent];
+    chrono::steady_clock::time_point t0;
+    long long c0[kPerfNEvent];
+  };
+
+  bool m_enabled;
+  MMPerfCounters m_counters;
+  vector<Stage> m_stages;
+};
+
+inline MMStageProfile::MMStageProfile(bool enable, bool counters){
+  m_enabled = enable;
+  if(m_enabled && counters)
+    m_counters.Open();
+}
+
+inline int MMStageProfile::AddStage(const string& name){
+  Stage stage;
+  stage.name = name;
+  stage.calls = 0;
+  stage.ns = 0.;
+  for(int e = 0; e < kPerfNEvent; e++){
+    stage.count[e] = 0;
+    stage.c0[e] = 0;
+  }
+  m_stages.push_back(stage);
+  return m_stages.size() - 1;
+}
+
+inline bool MMStageProfile::IsEnabled() const {
+  return m_enabled;
+}
+
+inline void MMStageProfile::Start(int k){
+  if(!m_enabled)
+    return;
+  Stage& stage = m_stages[k];
+  m_counters.Read(stage.c0);
+  stage.t0 = chrono::steady_clock::now();
+}
+
+inline void MMStageProfile::Stop(int k){
+  if(!m_enabled)
+    return;
+  Stage& stage = m_stages[k];
+  stage.ns += chrono::duration<double, nano>(chrono::steady_clock::now() - stage.t0).count();
+  long long c1[kPerfNEvent];
+  m_counters.Read(c1);
+  for(int e = 0; e < kPerfNEvent; e++)
+    stage.count[e] += c1[e] - stage.c0[e];
+  stage.calls++;
+}
+
+inline void MMStageProfile::Print(double Nevent, double Nhit) const {
+  if(!m_enabled || Nevent <= 0.)
+    return;
+  if(Nhit <= 0.)
+    Nhit = 1.;
+  bool counters = m_counters.IsOpen();
+
+  cout << "Stage profile: " << Nevent << " events, " << Nhit/Nevent << " hits/event";
+  if(counters && m_counters.Running() < 0.999)
+    cout << " (counters on the PMU " << 100.*m_counters.Running() << "% of the time)";
+  cout << endl;
+  cout << "  " << setw(16) << left << "stage" << right
+       << setw(12) << "ns/event" << setw(10) << "ns/hit";
+  if(counters)
+    cout << setw(12) << "cycles/hit" << setw(8) << "IPC"
+         << setw(12) << "L1D/hit" << setw(12) << "LLC/hit" << setw(12) << "br.miss/hit";
+  cout << endl;
+  for(const Stage& stage: m_stages){
+    if(stage.calls == 0)
+      continue;
+    cout << "  " << setw(16) << left << stage.name << right << fixed << setprecision(1)
+         << setw(12) << stage.ns/Nevent << setw(10) << stage.ns/Nhit;
+    if(counters){
+      if(m_counters.Has(kPerfCycles))
+        cout << setw(12) << stage.count[kPerfCycles]/Nhit;
+      else
+        cout << setw(12) << "-";
+      cout << setprecision(2);
+      if(m_counters.Has(kPerfInstructions) && stage.count[kPerfCycles] > 0)
+        cout << setw(8) << double(stage.count[kPerfInstructions])/stage.count[kPerfCycles];
+      else
+        cout << setw(8) << "-";
+      cout << setprecision(3);
+      for(int e: {kPerfL1DMiss, kPerfLLCMiss, kPerfBranchMiss}){
+        if(m_counters.Has(e))
+          cout << setw(12) << stage.count[e]/Nhit;
+        else
+          cout << setw(12) << "-";
+      }
+    }
+    cout << defaultfloat << setprecision(6) << endl;
+  }
+}
+
+#endif
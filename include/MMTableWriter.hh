@@ -0,0 +1,258 @@
+///
+///  \file   MMTableWriter.hh
+///
+///  \author A. Wang
+///
+///  \date   2026 Oct
+///
+
+
+#ifndef MMTableWriter_HH
+#define MMTableWriter_HH
+
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <Compression.h>
+#include <TFile.h>
+#include <TTree.h>
+#include <TDirectory.h>
+
+#include "include/MMCluster.hh"
+#include "include/MMClusterList.hh"
+
+using namespace std;
+
+///////////////////////////////////////////////
+// MMTableWriter class
+//
+// The derived quantities of the event loop as
+// flat tables, for a second stage that makes
+// new histograms with other cuts by scanning
+// columns (TTree::Draw, RDataFrame) instead
+// of decoding, calibrating and clustering the
+// run again. Two trees of plain numbers, ZSTD
+// compressed:
+//
+//   events:   one row per entry: trigger
+//             dBCIDs, trigger windows passed,
+//             hits and clusters per board, and
+//             the boards 0/1 track (x0, x1, dx,
+//             strips, holes) if there is one,
+//             and whether it is fiducial
+//   clusters: one row per cluster of the
+//             clustering (before track
+//             finding): board, x, charge,
+//             time, strips, holes
+//
+// joined on (run, entry). A row of events is
+// filled at the next BeginEvent() or Close(),
+// so that every exit of the loop body keeps
+// what the event has reached
+///////////////////////////////////////////////
+
+class MMTableWriter {
+
+public:
+  MMTableWriter(const string& filename = "");
+  ~MMTableWriter();
+
+  bool IsEnabled() const;
+  const string& GetFileName() const;
+
+  bool Open(int run, int nboards);
+  // returns the number of event rows, -1 if not open
+  Long64_t Close();
+
+  void BeginEvent(Long64_t entry, int dBCID, int dBCIDrel);
+  void PassTrigger();
+  // one board of the event and its clusters
+  void AddBoard(int board, int Nhit, const MMClusterList& clusters);
+  // one cluster on each of boards 0 and 1, before the fiducial cut
+  void SetTrack(double x0, double x1, double dx, int nstrips0, int nstrips1,
+                int holes0, int holes1, bool fiducial);
+
+private:
+  string m_filename;
+  TFile* m_file;
+  TTree* m_events;
+  TTree* m_clusters;
+  bool m_pending;
+
+  // events row
+  Int_t    m_run;
+  Long64_t m_entry;
+  Int_t    m_dBCID;
+  Int_t    m_dBCIDrel;
+  Bool_t   m_trigger;
+  Int_t    m_nboard;
+  vector<Int_t> m_nhits;
+  vector<Int_t> m_nclus;
+  Bool_t   m_track;
+  Double_t m_x0, m_x1, m_dx;
+  Int_t    m_nstrips0, m_nstrips1;
+  Int_t    m_holes0, m_holes1;
+  Bool_t   m_fiducial;
+
+  // clusters row
+  Int_t    m_board;
+  Double_t m_x, m_charge, m_time;
+  Int_t    m_nstrips, m_holes;
+};
+
+inline MMTableWriter::MMTableWriter(const string& filename){
+  m_filename = filename;
+  m_file = nullptr;
+  m_events = nullptr;
+  m_clusters = nullptr;
+  m_pending = false;
+  m_run = -1;
+  m_nboard = 0;
+}
+
+inline MMTableWriter::~MMTableWriter(){
+  Close();
+}
+
+inline bool MMTableWriter::IsEnabled() const {
+  return !m_filename.empty();
+}
+
+inline const string& MMTableWriter::GetFileName() const {
+  return m_filename;
+}
+
+inline bool MMTableWriter::Open(int run, int nboards){
+  if(!IsEnabled() || m_file)
+    return false;
+  // the histograms of the job stay in the current directory
+  TDirectory* dir = gDirectory;
+  m_file = new TFile(m_filename.c_str(), "RECREATE", "",
+                     ROOT::CompressionSettings(ROOT::RCompressionSetting::EAlgorithm::kZSTD, 5));
+  if(!m_file || m_file->IsZombie()){
+    cout << "MMTableWriter ERROR: cannot create " << m_filename << endl;
+    delete m_file;
+    m_file = nullptr;
+    if(dir)
+      dir->cd();
+    return false;
+  }
+  m_run = run;
+  m_nboard = nboards;
+  m_nhits.assign(nboards, 0);
+  m_nclus.assign(nboards, 0);
+
+  m_file->cd();
+  m_events = new TTree("events", "events");
+  m_events->Branch("run",      &m_run,      "run/I");
+  m_events->Branch("entry",    &m_entry,    "entry/L");
+  m_events->Branch("dBCID",    &m_dBCID,    "dBCID/I");
+  m_events->Branch("dBCIDrel", &m_dBCIDrel, "dBCIDrel/I");
+  m_events->Branch("trigger",  &m_trigger,  "trigger/O");
+  m_events->Branch("nboard",   &m_nboard,   "nboard/I");
+  m_events->Branch("nhits",    m_nhits.data(), "nhits[nboard]/I");
+  m_events->Branch("nclus",    m_nclus.data(), "nclus[nboard]/I");
+  m_events->Branch("track",    &m_track,    "track/O");
+  m_events->Branch("x0",       &m_x0,       "x0/D");
+  m_events->Branch("x1",       &m_x1,       "x1/D");
+  m_events->Branch("dx",       &m_dx,       "dx/D");
+  m_events->Branch("nstrips0", &m_nstrips0, "nstrips0/I");
+  m_events->Branch("nstrips1", &m_nstrips1, "nstrips1/I");
+  m_events->Branch("holes0",   &m_holes0,   "holes0/I");
+  m_events->Branch("holes1",   &m_holes1,   "holes1/I");
+  m_events->Branch("fiducial", &m_fiducial, "fiducial/O");
+
+  m_clusters = new TTree("clusters", "clusters");
+  m_clusters->Branch("run",     &m_run,     "run/I");
+  m_clusters->Branch("entry",   &m_entry,   "entry/L");
+  m_clusters->Branch("board",   &m_board,   "board/I");
+  m_clusters->Branch("x",       &m_x,       "x/D");
+  m_clusters->Branch("charge",  &m_charge,  "charge/D");
+  m_clusters->Branch("time",    &m_time,    "time/D");
+  m_clusters->Branch("nstrips", &m_nstrips, "nstrips/I");
+  m_clusters->Branch("holes",   &m_holes,   "holes/I");
+
+  if(dir)
+    dir->cd();
+  m_pending = false;
+  return true;
+}
+
+inline void MMTableWriter::BeginEvent(Long64_t entry, int dBCID, int dBCIDrel){
+  if(!m_file)
+    return;
+  if(m_pending)
+    m_events->Fill();
+  m_pending = true;
+  m_entry = entry;
+  m_dBCID = dBCID;
+  m_dBCIDrel = dBCIDrel;
+  m_trigger = false;
+  for(int b = 0; b < m_nboard; b++){
+    m_nhits[b] = 0;
+    m_nclus[b] = 0;
+  }
+  m_track = false;
+  m_x0 = m_x1 = m_dx = 0.;
+  m_nstrips0 = m_nstrips1 = 0;
+  m_holes0 = m_holes1 = -1;
+  m_fiducial = false;
+}
+
+inline void MMTableWriter::PassTrigger(){
+  m_trigger = true;
+}
+
+inline void MMTableWriter::AddBoard(int board, int Nhit, const MMClusterList& clusters){
+  if(!m_file || board < 0 || board >= m_nboard)
+    return;
+  m_nhits[board] = Nhit;
+  m_nclus[board] = clusters.GetNCluster();
+  m_board = board;
+  for(int c = 0; c < clusters.GetNCluster(); c++){
+    const MMCluster& clus = clusters[c];
+    m_x       = clus.Channel()*0.4;
+    m_charge  = clus.Charge();
+    m_time    = clus.Time();
+    m_nstrips = clus.GetNHits();
+    m_holes   = clus.NHoles();
+    m_clusters->Fill();
+  }
+}
+
+inline void MMTableWriter::SetTrack(double x0, double x1, double dx, int nstrips0, int nstrips1,
+                                    int holes0, int holes1, bool fiducial){
+  m_track = true;
+  m_x0 = x0;
+  m_x1 = x1;
+  m_dx = dx;
+  m_nstrips0 = nstrips0;
+  m_nstrips1 = nstrips1;
+  m_holes0 = holes0;
+  m_holes1 = holes1;
+  m_fiducial = fiducial;
+}
+
+inline Long64_t MMTableWriter::Close(){
+  if(!m_file)
+    return -1;
+  if(m_pending)
+    m_events->Fill();
+  m_pending = false;
+  Long64_t Nrow = m_events->GetEntries();
+  TDirectory* dir = (gDirectory == m_file) ? nullptr : gDirectory;
+  m_file->cd();
+  m_events->Write();
+  m_clusters->Write();
+  m_file->Close();
+  delete m_file;
+  m_file = nullptr;
+  m_events = nullptr;
+  m_clusters = nullptr;
+  if(dir)
+    dir->cd();
+  return Nrow;
+}
+
+#endif
@@ -10,6 +10,8 @@
 #ifndef TPHit_HH
 #define TPHit_HH
 
+#include "include/MMConditions.hh"
+
 class TPHit {
 
 public:
@@ -144,72 +146,11 @@ inline void TPHit::SetRunNumber(int RunNumber){
 }
 
 inline void TPHit::SetMMFE8Index(int RunNumber) {
-  // only valid for Run 3513.
-  // lets put this info into the ntuple?
+  // board maps per run range are in MMConditions (tp_boards)
   m_MMFE8index = -1;
-  if (RunNumber == 3513) {
-    if      (m_MMFE8 == 111) m_MMFE8index = 0;
-    else if (m_MMFE8 == 116) m_MMFE8index = 1;
-    else if (m_MMFE8 == 101) m_MMFE8index = 2;
-    else if (m_MMFE8 == 109) m_MMFE8index = 3;
-    else if (m_MMFE8 == 117) m_MMFE8index = 4;
-    else if (m_MMFE8 == 102) m_MMFE8index = 5;
-    else if (m_MMFE8 == 107) m_MMFE8index = 6;
-    else if (m_MMFE8 == 105) m_MMFE8index = 7;
-  }
-  else if (RunNumber == 3516) {
-    if      (m_MMFE8 == 111) m_MMFE8index = 0;
-    else if (m_MMFE8 == 116) m_MMFE8index = 1;
-    else if (m_MMFE8 == 117) m_MMFE8index = 2;
-    else if (m_MMFE8 == 119) m_MMFE8index = 3;
-    else if (m_MMFE8 == 106) m_MMFE8index = 4;
-    else if (m_MMFE8 == 107) m_MMFE8index = 5;
-    else if (m_MMFE8 == 118) m_MMFE8index = 6;
-    else if (m_MMFE8 == 105) m_MMFE8index = 7;
-  }
-  else if (RunNumber >= 3518 && RunNumber < 3524) {
-    if      (m_MMFE8 == 118) m_MMFE8index = 0;
-    else if (m_MMFE8 == 116) m_MMFE8index = 1;
-    else if (m_MMFE8 == 102) m_MMFE8index = 2;
-    else if (m_MMFE8 == 119) m_MMFE8index = 3;
-    else if (m_MMFE8 == 106) m_MMFE8index = 4;
-    else if (m_MMFE8 == 107) m_MMFE8index = 5;
-    else if (m_MMFE8 == 117) m_MMFE8index = 6;
-    else if (m_MMFE8 == 105) m_MMFE8index = 7;
-  }
-  else if (RunNumber == 3524) {
-    if      (m_MMFE8 == 118) m_MMFE8index = 0;
-    else if (m_MMFE8 == 116) m_MMFE8index = 1;
-    else if (m_MMFE8 == 102) m_MMFE8index = 2;
-    else if (m_MMFE8 == 119) m_MMFE8index = 3;
-    else if (m_MMFE8 == 106) m_MMFE8index = 4;
-    else if (m_MMFE8 == 107) m_MMFE8index = 5;
-    else if (m_MMFE8 == 101) m_MMFE8index = 6;
-    else if (m_MMFE8 == 105) m_MMFE8index = 7;
-  }
-  else if (RunNumber >= 3525 && RunNumber < 3540) {
-    if      (m_MMFE8 == 118) m_MMFE8index = 0;
-    else if (m_MMFE8 == 111) m_MMFE8index = 1;
-    else if (m_MMFE8 == 120) m_MMFE8index = 2;
-    else if (m_MMFE8 == 119) m_MMFE8index = 3;
-    else if (m_MMFE8 == 106) m_MMFE8index = 4;
-    else if (m_MMFE8 == 107) m_MMFE8index = 5;
-    else if (m_MMFE8 == 101) m_MMFE8index = 6;
-    else if (m_MMFE8 == 105) m_MMFE8index = 7;
-  }
-  else if (RunNumber >= 3540) {
-    if      (m_MMFE8 == 119) m_MMFE8index = 0;
-    else if (m_MMFE8 == 124) m_MMFE8index = 1;
-    else if (m_MMFE8 == 122) m_MMFE8index = 2;
-    else if (m_MMFE8 == 126) m_MMFE8index = 3;
-    else if (m_MMFE8 == 106) m_MMFE8index = 4;
-    else if (m_MMFE8 == 109) m_MMFE8index = 5;
-    else if (m_MMFE8 == 125) m_MMFE8index = 6;
-    else if (m_MMFE8 == 123) m_MMFE8index = 7;
-  }
-  else {
-    std::cout << "Need to add RunNumber settings to include/TPHit.hh! Error!" << std::endl;
-  }
+  if (RunNumber < 0)
+    return;
+  m_MMFE8index = MMConditions::Get().TPBoardIndex(RunNumber, m_MMFE8);
 }
 
 #endif